@@ -0,0 +1,111 @@
+#include <sql2++/scan.h>
+
+#include "helpers.h"
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace benchmarks
+	{
+		namespace
+		{
+			struct sample
+			{
+				int id;
+				string name;
+				int64_t value;
+				double weight;
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, sample *)
+			{
+				visitor("samples");
+				visitor(identity, &sample::id, "id");
+				visitor(&sample::name, "name");
+				visitor(&sample::value, "value");
+				visitor(&sample::weight, "weight");
+			}
+
+			void run_profile(results_t &results, const string &profile, const connection_options &options)
+			{
+				const size_t commits = 200, bulk_rows = 100000, scans = 10;
+				temporary_database db("sql2pp-bench-connection.db");
+				auto conn = create_connection(db.path(), options);
+				sample s = {	0, "lorem ipsum dolor", 0, 0.0	};
+
+				execute(conn, "CREATE TABLE samples (id INTEGER PRIMARY KEY, name TEXT NOT NULL, value INTEGER NOT NULL, "
+					"weight REAL NOT NULL)");
+
+				measure(results, "connection.commit_per_row", profile, commits, [&] {
+					for (auto n = commits; n--; s.value++)
+					{
+						transaction t(conn);
+
+						t.insert<sample>()(s);
+						t.commit();
+					}
+				});
+
+				measure(results, "connection.bulk_insert", profile, bulk_rows, [&] {
+					transaction t(conn);
+					auto ins = t.insert<sample>();
+
+					for (auto n = bulk_rows; n--; s.value++, s.weight += 0.5)
+						ins(s);
+					t.commit();
+				});
+
+				measure(results, "connection.scan", profile, scans * (bulk_rows + commits), [&] {
+					for (auto n = scans; n--; )
+					{
+						transaction t(conn);
+						auto r = t.select<sample>();
+
+						while (r(s))
+						{	}
+					}
+				});
+			}
+
+			void run_parallel_scan(results_t &results)
+			{
+				const size_t rows = 1000000;
+				temporary_database db("sql2pp-bench-scan.db");
+				connection_pool pool(db.path(), 8);
+				sample s = {	0, "lorem ipsum dolor", 0, 0.0	};
+
+				{
+					transaction t(pool.write());
+
+					t.create_table<sample>();
+
+					auto ins = t.insert<sample>();
+
+					for (auto n = rows; n--; s.value++, s.weight += 0.5)
+						ins(s);
+					t.commit();
+				}
+
+				for (size_t partitions = 1; partitions <= 8; partitions *= 2)
+				{
+					vector<double> totals(partitions);
+
+					measure(results, "parallel_scan." + to_string(partitions), "sql2xx", rows, [&] {
+						parallel_scan<sample>(pool, partitions, [&] (size_t partition, const sample &record) {
+							totals[partition] += record.weight;
+						});
+					});
+				}
+			}
+		}
+
+		void connection_benchmarks(results_t &results)
+		{
+			run_profile(results, "default", connection_options());
+			run_profile(results, "tuned", connection_options::tuned());
+			run_parallel_scan(results);
+		}
+	}
+}
@@ -0,0 +1,419 @@
+#include <sql2++/database.h>
+
+#include "helpers.h"
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace benchmarks
+	{
+		namespace
+		{
+			struct narrow
+			{
+				int id;
+				int value;
+			};
+
+			struct wide
+			{
+				int id;
+				int a;
+				int64_t b;
+				double c;
+				double d;
+				string e;
+				string f;
+				string g;
+				int h;
+				int value;
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, narrow *)
+			{
+				visitor("narrow");
+				visitor(identity, &narrow::id, "id");
+				visitor(&narrow::value, "value");
+			}
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, wide *)
+			{
+				visitor("wide");
+				visitor(identity, &wide::id, "id");
+				visitor(&wide::a, "a");
+				visitor(&wide::b, "b");
+				visitor(&wide::c, "c");
+				visitor(&wide::d, "d");
+				visitor(&wide::e, "e");
+				visitor(&wide::f, "f");
+				visitor(&wide::g, "g");
+				visitor(&wide::h, "h");
+				visitor(&wide::value, "value");
+			}
+
+			struct narrow_raw
+			{
+				static narrow make(int n)
+				{
+					narrow r = {	0, n	};
+					return r;
+				}
+
+				static const char *insert_sql()
+				{	return "INSERT INTO narrow (value) VALUES (?)";	}
+
+				static const char *select_sql()
+				{	return "SELECT id,value FROM narrow";	}
+
+				static const char *select_by_id_sql()
+				{	return "SELECT id,value FROM narrow WHERE id=?";	}
+
+				static const char *update_sql()
+				{	return "UPDATE narrow SET value=? WHERE id=?";	}
+
+				static const char *update_record_sql()
+				{	return "UPDATE narrow SET value=? WHERE id=?";	}
+
+				static const char *remove_sql()
+				{	return "DELETE FROM narrow WHERE id=?";	}
+
+				static void bind(sqlite3_stmt *s, const narrow &r)
+				{	sqlite3_bind_int(s, 1, r.value);	}
+
+				static void read(sqlite3_stmt *s, narrow &r)
+				{
+					r.id = sqlite3_column_int(s, 0);
+					r.value = sqlite3_column_int(s, 1);
+				}
+			};
+
+			struct wide_raw
+			{
+				static wide make(int n)
+				{
+					wide r = {	0, n, n * 1000ll, n * 0.5, n * 0.25, "lorem ipsum", "dolor sit amet", "consectetur", n, n	};
+					return r;
+				}
+
+				static const char *insert_sql()
+				{	return "INSERT INTO wide (a,b,c,d,e,f,g,h,value) VALUES (?,?,?,?,?,?,?,?,?)";	}
+
+				static const char *select_sql()
+				{	return "SELECT id,a,b,c,d,e,f,g,h,value FROM wide";	}
+
+				static const char *select_by_id_sql()
+				{	return "SELECT id,a,b,c,d,e,f,g,h,value FROM wide WHERE id=?";	}
+
+				static const char *update_sql()
+				{	return "UPDATE wide SET value=? WHERE id=?";	}
+
+				static const char *update_record_sql()
+				{	return "UPDATE wide SET a=?,b=?,c=?,d=?,e=?,f=?,g=?,h=?,value=? WHERE id=?";	}
+
+				static const char *remove_sql()
+				{	return "DELETE FROM wide WHERE id=?";	}
+
+				static void bind(sqlite3_stmt *s, const wide &r)
+				{
+					sqlite3_bind_int(s, 1, r.a);
+					sqlite3_bind_int64(s, 2, r.b);
+					sqlite3_bind_double(s, 3, r.c);
+					sqlite3_bind_double(s, 4, r.d);
+					sqlite3_bind_text(s, 5, r.e.data(), static_cast<int>(r.e.size()), SQLITE_STATIC);
+					sqlite3_bind_text(s, 6, r.f.data(), static_cast<int>(r.f.size()), SQLITE_STATIC);
+					sqlite3_bind_text(s, 7, r.g.data(), static_cast<int>(r.g.size()), SQLITE_STATIC);
+					sqlite3_bind_int(s, 8, r.h);
+					sqlite3_bind_int(s, 9, r.value);
+				}
+
+				static void read_text(sqlite3_stmt *s, int index, string &value)
+				{
+					value.assign(reinterpret_cast<const char *>(sqlite3_column_text(s, index)),
+						static_cast<size_t>(sqlite3_column_bytes(s, index)));
+				}
+
+				static void read(sqlite3_stmt *s, wide &r)
+				{
+					r.id = sqlite3_column_int(s, 0);
+					r.a = sqlite3_column_int(s, 1);
+					r.b = sqlite3_column_int64(s, 2);
+					r.c = sqlite3_column_double(s, 3);
+					r.d = sqlite3_column_double(s, 4);
+					read_text(s, 5, r.e);
+					read_text(s, 6, r.f);
+					read_text(s, 7, r.g);
+					r.h = sqlite3_column_int(s, 8);
+					r.value = sqlite3_column_int(s, 9);
+				}
+			};
+
+			class raw_statement
+			{
+			public:
+				raw_statement(const connection_ptr &connection, const char *sql)
+					: _statement(nullptr)
+				{	sqlite3_prepare_v2(connection.get(), sql, -1, &_statement, nullptr);	}
+
+				~raw_statement()
+				{	sqlite3_finalize(_statement);	}
+
+				operator sqlite3_stmt *() const
+				{	return _statement;	}
+
+			private:
+				sqlite3_stmt *_statement;
+			};
+
+			template <typename T, typename RawT>
+			void run_crud(results_t &results, const string &width, int rows, int lookups)
+			{
+				temporary_database db1("sql2pp-bench-crud-1.db"), db2("sql2pp-bench-crud-2.db");
+				auto conn = create_connection(db1.path(), connection_options::tuned());
+				auto raw_conn = create_connection(db2.path(), connection_options::tuned());
+				T record = RawT::make(0);
+				int64_t checksum = 0;
+
+				{
+					transaction t(conn);
+
+					t.create_table<T>();
+					t.commit();
+				}
+				{
+					transaction t(raw_conn);
+
+					t.create_table<T>();
+					t.commit();
+				}
+
+				measure(results, "insert." + width, "sql2xx", rows, [&] {
+					transaction t(conn);
+					auto ins = t.insert<T>();
+
+					for (auto n = 0; n != rows; ++n)
+						record = RawT::make(n), ins(record);
+					t.commit();
+				});
+				measure(results, "insert." + width, "raw", rows, [&] {
+					execute(raw_conn, "BEGIN");
+					{
+						raw_statement s(raw_conn, RawT::insert_sql());
+
+						for (auto n = 0; n != rows; ++n)
+						{
+							record = RawT::make(n);
+							RawT::bind(s, record);
+							sqlite3_step(s);
+							sqlite3_reset(s);
+							record.id = static_cast<int>(sqlite3_last_insert_rowid(raw_conn.get()));
+						}
+					}
+					execute(raw_conn, "COMMIT");
+				});
+
+				measure(results, "select." + width, "sql2xx", rows, [&] {
+					transaction t(conn);
+					auto r = t.select<T>();
+
+					while (r(record))
+						checksum += record.value;
+				});
+				measure(results, "select." + width, "raw", rows, [&] {
+					execute(conn, "BEGIN");
+					{
+						raw_statement s(conn, RawT::select_sql());
+
+						while (SQLITE_ROW == sqlite3_step(s))
+							RawT::read(s, record), checksum += record.value;
+					}
+					execute(conn, "COMMIT");
+				});
+
+				measure(results, "select_where." + width, "sql2xx", lookups, [&] {
+					transaction t(conn);
+
+					for (auto id = 1; id <= lookups; ++id)
+					{
+						auto r = t.select<T>(c(&T::id) == p(id));
+
+						if (r(record))
+							checksum += record.value;
+					}
+				});
+				measure(results, "select_where." + width, "raw", lookups, [&] {
+					execute(conn, "BEGIN");
+					{
+						raw_statement s(conn, RawT::select_by_id_sql());
+
+						for (auto id = 1; id <= lookups; ++id)
+						{
+							sqlite3_bind_int(s, 1, id);
+							if (SQLITE_ROW == sqlite3_step(s))
+								RawT::read(s, record), checksum += record.value;
+							sqlite3_reset(s);
+						}
+					}
+					execute(conn, "COMMIT");
+				});
+
+				measure(results, "update." + width, "sql2xx", lookups, [&] {
+					transaction t(conn);
+					int id = 0, value = 0;
+					auto u = t.update<T>(c(&T::id) == p(id), &T::value, value);
+
+					for (id = 1; id <= lookups; ++id)
+					{
+						value = id * 3;
+						u.reset();
+						u.execute();
+					}
+					t.commit();
+				});
+				measure(results, "update." + width, "raw", lookups, [&] {
+					execute(conn, "BEGIN");
+					{
+						raw_statement s(conn, RawT::update_sql());
+
+						for (auto id = 1; id <= lookups; ++id)
+						{
+							sqlite3_bind_int(s, 1, id * 5);
+							sqlite3_bind_int(s, 2, id);
+							sqlite3_step(s);
+							sqlite3_reset(s);
+						}
+					}
+					execute(conn, "COMMIT");
+				});
+
+				vector<T> records;
+
+				{
+					transaction t(conn);
+					auto r = t.select<T>();
+
+					for (T item; r(item); )
+						item.value++, records.push_back(item);
+				}
+				measure(results, "update_records." + width, "sql2xx", records.size(), [&] {
+					transaction t(conn);
+
+					checksum += t.update_records<T>(records);
+					t.commit();
+				});
+				measure(results, "update_records." + width, "raw", records.size(), [&] {
+					execute(conn, "BEGIN");
+					{
+						raw_statement s(conn, RawT::update_record_sql());
+
+						for (auto i = records.begin(); i != records.end(); ++i)
+						{
+							RawT::bind(s, *i);
+							sqlite3_bind_int(s, sqlite3_bind_parameter_count(s), i->id);
+							sqlite3_step(s);
+							checksum += sqlite3_changes(conn.get());
+							sqlite3_reset(s);
+						}
+					}
+					execute(conn, "COMMIT");
+				});
+
+				measure(results, "remove." + width, "sql2xx", lookups, [&] {
+					transaction t(conn);
+					int id = 0;
+					auto r = t.remove<T>(c(&T::id) == p(id));
+
+					for (id = 1; id <= lookups; ++id)
+					{
+						r.reset();
+						r.execute();
+					}
+					t.commit();
+				});
+				measure(results, "remove." + width, "raw", lookups, [&] {
+					execute(conn, "BEGIN");
+					{
+						raw_statement s(conn, RawT::remove_sql());
+
+						for (auto id = lookups + 1; id <= 2 * lookups; ++id)
+						{
+							sqlite3_bind_int(s, 1, id);
+							sqlite3_step(s);
+							sqlite3_reset(s);
+						}
+					}
+					execute(conn, "COMMIT");
+				});
+
+				if (!checksum)
+					std::printf("%s: unexpected checksum!\n", width.c_str());
+			}
+
+			void run_multi_column_update(results_t &results, int rows, int lookups)
+			{
+				temporary_database db("sql2pp-bench-crud-3.db");
+				auto conn = create_connection(db.path(), connection_options::tuned());
+
+				{
+					transaction t(conn);
+
+					t.create_table<wide>();
+
+					auto ins = t.insert<wide>();
+
+					for (auto n = 0; n != rows; ++n)
+					{
+						auto record = wide_raw::make(n);
+
+						ins(record);
+					}
+					t.commit();
+				}
+
+				measure(results, "update_4_columns.wide", "sql2xx", lookups, [&] {
+					transaction t(conn);
+					int id = 0, a = 0, value = 0;
+					int64_t b = 0;
+					double c_ = 0;
+					auto u = t.update<wide>(c(&wide::id) == p(id), &wide::a, a, &wide::b, b, &wide::c, c_,
+						&wide::value, value);
+
+					for (id = 1; id <= lookups; ++id)
+					{
+						a = id, b = id * 2, c_ = id * 0.5, value = id * 3;
+						u.reset();
+						u.execute();
+					}
+					t.commit();
+				});
+				measure(results, "update_4_columns.wide", "raw", lookups, [&] {
+					execute(conn, "BEGIN");
+					{
+						raw_statement s(conn, "UPDATE wide SET a=?,b=?,c=?,value=? WHERE id=?");
+
+						for (auto id = 1; id <= lookups; ++id)
+						{
+							sqlite3_bind_int(s, 1, id);
+							sqlite3_bind_int64(s, 2, id * 2);
+							sqlite3_bind_double(s, 3, id * 0.5);
+							sqlite3_bind_int(s, 4, id * 3);
+							sqlite3_bind_int(s, 5, id);
+							sqlite3_step(s);
+							sqlite3_reset(s);
+						}
+					}
+					execute(conn, "COMMIT");
+				});
+			}
+		}
+
+		void crud_benchmarks(results_t &results)
+		{
+			run_crud<narrow, narrow_raw>(results, "narrow", 200000, 20000);
+			run_crud<wide, wide_raw>(results, "wide", 100000, 20000);
+			run_multi_column_update(results, 100000, 100000);
+		}
+	}
+}
@@ -0,0 +1,189 @@
+#include <sql2++/database.h>
+
+#include "helpers.h"
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace benchmarks
+	{
+		namespace
+		{
+			struct customer
+			{
+				int id;
+				string name;
+			};
+
+			struct product
+			{
+				int id;
+				string title;
+				double price;
+			};
+
+			struct order
+			{
+				int id;
+				int customer_id;
+				int product_id;
+				int quantity;
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, customer *)
+			{
+				visitor("customers");
+				visitor(identity, &customer::id, "id");
+				visitor(&customer::name, "name");
+			}
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, product *)
+			{
+				visitor("products");
+				visitor(identity, &product::id, "id");
+				visitor(&product::title, "title");
+				visitor(&product::price, "price");
+			}
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, order *)
+			{
+				visitor("orders");
+				visitor(identity, &order::id, "id");
+				visitor(&order::customer_id, "customer_id");
+				visitor(&order::product_id, "product_id");
+				visitor(&order::quantity, "quantity");
+			}
+
+			void read_text(sqlite3_stmt *s, int index, string &value)
+			{
+				value.assign(reinterpret_cast<const char *>(sqlite3_column_text(s, index)),
+					static_cast<size_t>(sqlite3_column_bytes(s, index)));
+			}
+
+			void populate(const connection_ptr &conn, int customers, int products, int orders)
+			{
+				transaction t(conn);
+
+				t.create_table<customer>();
+				t.create_table<product>();
+				t.create_table<order>();
+
+				auto ic = t.insert<customer>();
+				auto ip = t.insert<product>();
+				auto io = t.insert<order>();
+
+				for (auto n = 0; n != customers; ++n)
+				{
+					customer c = {	0, "customer #" + to_string(n)	};
+					ic(c);
+				}
+				for (auto n = 0; n != products; ++n)
+				{
+					product p = {	0, "product #" + to_string(n), n * 1.5	};
+					ip(p);
+				}
+				for (auto n = 0; n != orders; ++n)
+				{
+					order o = {	0, 1 + n % customers, 1 + n % products, 1 + n % 7	};
+					io(o);
+				}
+				t.commit();
+			}
+		}
+
+		void join_benchmarks(results_t &results)
+		{
+			const int orders = 100000, scans = 5;
+			temporary_database db("sql2pp-bench-join.db");
+			auto conn = create_connection(db.path(), connection_options::tuned());
+			tuple<order, customer> r2;
+			tuple<order, customer, product> r3;
+			double checksum = 0;
+
+			populate(conn, 1000, 500, orders);
+
+			measure(results, "join2", "sql2xx", scans * orders, [&] {
+				for (auto n = scans; n--; )
+				{
+					transaction t(conn);
+					auto r = t.select< tuple<order, customer> >(c<0>(&order::customer_id) == c<1>(&customer::id));
+
+					while (r(r2))
+						checksum += get<0>(r2).quantity;
+				}
+			});
+			measure(results, "join2", "raw", scans * orders, [&] {
+				for (auto n = scans; n--; )
+				{
+					transaction t(conn);
+					sqlite3_stmt *s = nullptr;
+
+					sqlite3_prepare_v2(conn.get(), "SELECT t0.id,t0.customer_id,t0.product_id,t0.quantity,t1.id,t1.name "
+						"FROM orders AS t0,customers AS t1 WHERE t0.customer_id=t1.id", -1, &s, nullptr);
+					while (SQLITE_ROW == sqlite3_step(s))
+					{
+						auto &o = get<0>(r2);
+						auto &c = get<1>(r2);
+
+						o.id = sqlite3_column_int(s, 0);
+						o.customer_id = sqlite3_column_int(s, 1);
+						o.product_id = sqlite3_column_int(s, 2);
+						o.quantity = sqlite3_column_int(s, 3);
+						c.id = sqlite3_column_int(s, 4);
+						read_text(s, 5, c.name);
+						checksum += o.quantity;
+					}
+					sqlite3_finalize(s);
+				}
+			});
+
+			measure(results, "join3", "sql2xx", scans * orders, [&] {
+				for (auto n = scans; n--; )
+				{
+					transaction t(conn);
+					auto r = t.select< tuple<order, customer, product> >(c<0>(&order::customer_id) == c<1>(&customer::id)
+						&& c<0>(&order::product_id) == c<2>(&product::id));
+
+					while (r(r3))
+						checksum += get<0>(r3).quantity * get<2>(r3).price;
+				}
+			});
+			measure(results, "join3", "raw", scans * orders, [&] {
+				for (auto n = scans; n--; )
+				{
+					transaction t(conn);
+					sqlite3_stmt *s = nullptr;
+
+					sqlite3_prepare_v2(conn.get(), "SELECT t0.id,t0.customer_id,t0.product_id,t0.quantity,t1.id,t1.name,"
+						"t2.id,t2.title,t2.price FROM orders AS t0,customers AS t1,products AS t2 "
+						"WHERE t0.customer_id=t1.id AND t0.product_id=t2.id", -1, &s, nullptr);
+					while (SQLITE_ROW == sqlite3_step(s))
+					{
+						auto &o = get<0>(r3);
+						auto &c = get<1>(r3);
+						auto &p = get<2>(r3);
+
+						o.id = sqlite3_column_int(s, 0);
+						o.customer_id = sqlite3_column_int(s, 1);
+						o.product_id = sqlite3_column_int(s, 2);
+						o.quantity = sqlite3_column_int(s, 3);
+						c.id = sqlite3_column_int(s, 4);
+						read_text(s, 5, c.name);
+						p.id = sqlite3_column_int(s, 6);
+						read_text(s, 7, p.title);
+						p.price = sqlite3_column_double(s, 8);
+						checksum += o.quantity * p.price;
+					}
+					sqlite3_finalize(s);
+				}
+			});
+
+			if (!checksum)
+				std::printf("join: unexpected checksum!\n");
+		}
+	}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace sql2xx
+{
+	namespace benchmarks
+	{
+		struct result
+		{
+			std::string scenario;
+			std::string variant; // E.g. 'sql2xx' or 'raw' for hand-written sqlite3_* baselines.
+			std::size_t operations;
+			double seconds;
+		};
+
+		typedef std::vector<result> results_t;
+
+		class temporary_database
+		{
+		public:
+			temporary_database(const char *name);
+			~temporary_database();
+
+			const char *path() const;
+
+		private:
+			void remove_files() const;
+
+		private:
+			std::string _path;
+		};
+
+
+
+		template <typename F>
+		inline void measure(results_t &results, const std::string &scenario, const std::string &variant,
+			std::size_t operations, const F &f)
+		{
+			const auto start = std::chrono::high_resolution_clock::now();
+
+			f();
+
+			const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+			const result r = {	scenario, variant, operations, elapsed.count()	};
+
+			results.push_back(r);
+		}
+
+
+		inline temporary_database::temporary_database(const char *name)
+			: _path(name)
+		{	remove_files();	}
+
+		inline temporary_database::~temporary_database()
+		{	remove_files();	}
+
+		inline const char *temporary_database::path() const
+		{	return _path.c_str();	}
+
+		inline void temporary_database::remove_files() const
+		{
+			std::remove(_path.c_str());
+			std::remove((_path + "-wal").c_str());
+			std::remove((_path + "-shm").c_str());
+			std::remove((_path + "-journal").c_str());
+		}
+	}
+}
@@ -0,0 +1,88 @@
+#include "helpers.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace sql2xx
+{
+	namespace benchmarks
+	{
+		void connection_benchmarks(results_t &results);
+		void crud_benchmarks(results_t &results);
+		void join_benchmarks(results_t &results);
+
+		namespace
+		{
+			double ops_per_second(const result &r)
+			{	return r.operations / r.seconds;	}
+
+			const result *find_baseline(const results_t &results, const result &r)
+			{
+				for (auto i = results.begin(); i != results.end(); ++i)
+				{
+					if (i->scenario == r.scenario && i->variant == "raw")
+						return &*i;
+				}
+				return nullptr;
+			}
+
+			void print_table(const results_t &results)
+			{
+				std::printf("%-32s %-10s %10s %10s %14s %10s\n", "scenario", "variant", "ops", "seconds", "ops/s", "vs raw");
+				for (auto i = results.begin(); i != results.end(); ++i)
+				{
+					const auto baseline = find_baseline(results, *i);
+
+					std::printf("%-32s %-10s %10u %10.3f %14.0f", i->scenario.c_str(), i->variant.c_str(),
+						static_cast<unsigned>(i->operations), i->seconds, ops_per_second(*i));
+					if (baseline)
+						std::printf(" %9.2fx", i->seconds / baseline->seconds);
+					std::printf("\n");
+				}
+			}
+
+			bool write_json(const results_t &results, const char *path)
+			{
+				if (auto f = std::fopen(path, "w"))
+				{
+					std::fprintf(f, "{\n\t\"results\": [");
+					for (auto i = results.begin(); i != results.end(); ++i)
+					{
+						std::fprintf(f, "%s\n\t\t{\"scenario\": \"%s\", \"variant\": \"%s\", \"operations\": %u, "
+							"\"seconds\": %.6f, \"ops_per_second\": %.1f}", i == results.begin() ? "" : ",",
+							i->scenario.c_str(), i->variant.c_str(), static_cast<unsigned>(i->operations), i->seconds,
+							ops_per_second(*i));
+					}
+					std::fprintf(f, "\n\t]\n}\n");
+					std::fclose(f);
+					return true;
+				}
+				return false;
+			}
+		}
+	}
+}
+
+int main(int argc, const char *argv[])
+{
+	using namespace sql2xx::benchmarks;
+
+	const char *json_path = nullptr;
+	results_t results;
+
+	for (auto i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i], "--json") && i + 1 < argc)
+			json_path = argv[++i];
+		else
+			return std::fprintf(stderr, "usage: %s [--json <output-path>]\n", argv[0]), 1;
+	}
+
+	connection_benchmarks(results);
+	crud_benchmarks(results);
+	join_benchmarks(results);
+	print_table(results);
+	if (json_path && !write_json(results, json_path))
+		return std::fprintf(stderr, "cannot write '%s'\n", json_path), 1;
+	return 0;
+}
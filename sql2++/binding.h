@@ -21,10 +21,16 @@
 #pragma once
 
 #include "expression.h"
+#include "format.h"
 #include "statement.h"
 #include "types.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
 #include <string>
+#include <vector>
 
 namespace sql2xx
 {
@@ -37,7 +43,7 @@ namespace sql2xx
 
 		template <typename FieldT, typename U>
 		void operator ()(FieldT U::*field, const char *)
-		{	statement_.bind(index++, item.*field);	}
+		{	statement_.bind(index++, item.*field, lifetime);	}
 
 		template <typename TagT, typename U>
 		void operator ()(TagT, U, const char *)
@@ -50,6 +56,7 @@ namespace sql2xx
 		statement &statement_;
 		const T &item;
 		int index;
+		binding_lifetime lifetime;
 	};
 
 	template <typename T>
@@ -61,7 +68,7 @@ namespace sql2xx
 
 		template <typename U, typename T2>
 		void operator ()(identity_tag, U T2::*field, const char *)
-		{	item.*field = static_cast<U>(sqlite3_last_insert_rowid(&connection));	}
+		{	item.*field = static_cast<U>(rowid);	}
 
 		template <typename U>
 		void operator ()(U, const char *)
@@ -71,11 +78,69 @@ namespace sql2xx
 		identity_binder operator <<(U) const
 		{	return *this;	}
 
-		sqlite3 &connection;
+		std::int64_t rowid;
 		T &item;
 	};
 
 
+	template <typename T>
+	struct identity_field_binder
+	{
+		template <typename U>
+		void operator ()(U)
+		{	}
+
+		template <typename U, typename T2>
+		void operator ()(identity_tag, U T2::*field, const char *)
+		{	statement_.bind(index++, item.*field);	}
+
+		template <typename U>
+		void operator ()(U, const char *)
+		{	}
+
+		template <typename U>
+		identity_field_binder operator <<(U) const
+		{	return *this;	}
+
+		statement &statement_;
+		const T &item;
+		int index;
+	};
+
+
+	template <typename T, typename F>
+	struct field_index_visitor
+	{
+		template <typename U>
+		void operator ()(U)
+		{	}
+
+		template <typename U>
+		void operator ()(F U::*field_, const char *)
+		{
+			if (field_ == field)
+				found = index;
+			index++;
+		}
+
+		template <typename F2, typename U>
+		void operator ()(F2 U::*, const char *)
+		{	index++;	}
+
+		template <typename TagT, typename F2>
+		void operator ()(TagT, F2, const char *)
+		{	}
+
+		template <typename U>
+		field_index_visitor operator <<(U) const
+		{	return *this;	}
+
+		F T::*field;
+		int index;
+		int found;
+	};
+
+
 
 	template <typename T, typename F>
 	inline void bind_parameters(statement &/*statement_*/, const column<T, F> &/*e*/, unsigned int &/*index*/)
@@ -85,6 +150,10 @@ namespace sql2xx
 	inline void bind_parameters(statement &/*statement_*/, const prefixed_column<table_index, T, F> &/*e*/, unsigned int &/*index*/)
 	{	}
 
+	template <typename T>
+	inline void bind_parameters(statement &/*statement_*/, const literal<T> &/*e*/, unsigned int &/*index*/)
+	{	}
+
 	template <typename T>
 	inline void bind_parameters(statement &statement_, const parameter<T> &e, unsigned int &index)
 	{	statement_.bind(index++, e.object);	}
@@ -97,6 +166,128 @@ namespace sql2xx
 	inline void bind_parameters(statement &statement_, const unary_operator<U> &e, unsigned int &index)
 	{	bind_parameters(statement_, e.operand, index);	}
 
+	template <std::size_t i, std::size_t n>
+	struct row_value_binder
+	{
+		template <typename TupleT>
+		static void bind(statement &statement_, const TupleT &elements, unsigned int &index)
+		{
+			bind_parameters(statement_, std::get<i>(elements), index);
+			row_value_binder<i + 1, n>::bind(statement_, elements, index);
+		}
+	};
+
+	template <std::size_t n>
+	struct row_value_binder<n, n>
+	{
+		template <typename TupleT>
+		static void bind(statement &/*statement_*/, const TupleT &/*elements*/, unsigned int &/*index*/)
+		{	}
+	};
+
+	template <typename... E>
+	inline void bind_parameters(statement &statement_, const row_value<E...> &e, unsigned int &index)
+	{	row_value_binder<0, sizeof...(E)>::bind(statement_, e.elements, index);	}
+
+	template <std::size_t i, std::size_t n>
+	struct values_binder
+	{
+		template <typename TupleT>
+		static void bind(statement &statement_, const TupleT &values, unsigned int &index)
+		{
+			statement_.bind(index++, std::get<i>(values));
+			values_binder<i + 1, n>::bind(statement_, values, index);
+		}
+	};
+
+	template <std::size_t n>
+	struct values_binder<n, n>
+	{
+		template <typename TupleT>
+		static void bind(statement &/*statement_*/, const TupleT &/*values*/, unsigned int &/*index*/)
+		{	}
+	};
+
+	template <typename... V>
+	inline void bind_values(statement &statement_, const std::tuple<V...> &values, unsigned int &index)
+	{	values_binder<0, sizeof...(V)>::bind(statement_, values, index);	}
+
+	template <typename IteratorT>
+	inline void bind_in_list(statement &statement_, IteratorT begin_, IteratorT end_, std::size_t size,
+		unsigned int &index)
+	{
+		auto last = end_;
+
+		for (auto i = begin_; i != end_; ++i, --size)
+			statement_.bind(index++, *(last = i));
+		while (size--)
+			statement_.bind(index++, *last);
+	}
+
+	template <typename E, typename ContainerT>
+	inline void bind_in_list_chunk(statement &statement_, const in_predicate<E, ContainerT> &e, unsigned int &index)
+	{
+		typedef std::vector<typename ContainerT::value_type> distinct_values_t;
+
+		const auto size = e.list_size;
+		auto &chunks = e.chunks;
+
+		if (!chunks.allowed)
+			throw sql_error("An IN list bound in chunks can only be AND-ed with the rest of the condition");
+		if (!chunks.values)
+		{
+			// Values are made distinct, so that no record is matched by more than one chunk.
+			const auto distinct = std::make_shared<distinct_values_t>(std::begin(e.values), std::end(e.values));
+
+			std::sort(distinct->begin(), distinct->end());
+			distinct->erase(std::unique(distinct->begin(), distinct->end()), distinct->end());
+			chunks.current = 0;
+			chunks.count = (distinct->size() + size - 1) / size;
+			chunks.values = distinct;
+		}
+
+		const auto &distinct = *static_cast<const distinct_values_t *>(chunks.values.get());
+		const auto first = distinct.begin() + chunks.current * size;
+
+		bind_in_list(statement_, first, first + (std::min)(size, static_cast<std::size_t>(distinct.end() - first)),
+			size, index);
+	}
+
+	template <typename E, typename ContainerT>
+	inline void bind_parameters(statement &statement_, const in_predicate<E, ContainerT> &e, unsigned int &index)
+	{
+		bind_parameters(statement_, e.operand, index);
+		if (e.binding == json_array_binding)
+		{
+			std::string json;
+
+			format_json_array(json, e.values);
+			statement_.bind(index++, json);
+		}
+		else if (!e.values.size() != !e.list_size)
+		{
+			throw sql_error("An IN list cannot become empty, or stop being empty, once formatted");
+		}
+		else if (e.chunks.values || e.values.size() > e.list_size)
+		{
+			bind_in_list_chunk(statement_, e, index); // Subsequent chunks are bound from a copy.
+		}
+		else
+		{
+			bind_in_list(statement_, std::begin(e.values), std::end(e.values), e.list_size, index);
+		}
+	}
+
+	template <typename E, typename R>
+	inline void bind_parameters(statement &statement_, const aggregate<E, R> &e, unsigned int &index)
+	{	bind_parameters(statement_, e.operand, index);	}
+
+	inline void bind_parameters(statement &/*statement_*/, const count_all &/*e*/, unsigned int &/*index*/)
+	{	}
+
+	inline void bind_parameters(statement &/*statement_*/, const rowid_column &/*e*/, unsigned int &/*index*/)
+	{	}
+
 	template <typename E>
 	inline void bind_parameters(statement &statement_, const E &e)
 	{
@@ -105,19 +296,154 @@ namespace sql2xx
 		bind_parameters(statement_, e, index);
 	}
 
+
+	// Allows IN lists that are only AND-ed with the rest of a condition to be bound in chunks. It is called once on
+	// the copy of the condition a statement is bound from.
+	template <typename E>
+	inline void allow_in_chunks(const E &/*e*/)
+	{	}
+
+	template <typename E, typename R>
+	inline void allow_in_chunks(const wrapped<E, R> &e)
+	{	allow_in_chunks(static_cast<const E &>(e));	}
+
+	template <typename L, typename R>
+	inline void allow_in_chunks(const binary_operator<L, R> &e)
+	{
+		if (!std::strcmp(e.literal, " AND "))
+			allow_in_chunks(e.lhs), allow_in_chunks(e.rhs);
+	}
+
+	template <typename E, typename ContainerT>
+	inline void allow_in_chunks(const in_predicate<E, ContainerT> &e)
+	{	e.chunks.allowed = true;	}
+
+	// Tells if the condition last bound has an IN list bound in more than one chunk.
+	template <typename E>
+	inline bool in_chunked(const E &/*e*/)
+	{	return false;	}
+
+	template <typename E, typename R>
+	inline bool in_chunked(const wrapped<E, R> &e)
+	{	return in_chunked(static_cast<const E &>(e));	}
+
+	template <typename L, typename R>
+	inline bool in_chunked(const binary_operator<L, R> &e)
+	{	return in_chunked(e.lhs) || in_chunked(e.rhs);	}
+
+	template <typename E, typename ContainerT>
+	inline bool in_chunked(const in_predicate<E, ContainerT> &e)
+	{	return e.chunks.count > 1;	}
+
+	// Moves IN lists of a condition to their next chunks, to be bound again. Returns false, rewinding them, once all
+	// chunks (of all lists) are done.
+	template <typename E>
+	inline bool next_in_chunk(const E &/*e*/)
+	{	return false;	}
+
+	template <typename E, typename R>
+	inline bool next_in_chunk(const wrapped<E, R> &e)
+	{	return next_in_chunk(static_cast<const E &>(e));	}
+
+	template <typename L, typename R>
+	inline bool next_in_chunk(const binary_operator<L, R> &e)
+	{	return next_in_chunk(e.lhs) || next_in_chunk(e.rhs);	}
+
+	template <typename E, typename ContainerT>
+	inline bool next_in_chunk(const in_predicate<E, ContainerT> &e)
+	{
+		if (!e.chunks.values)
+			return false;
+		if (++e.chunks.current < e.chunks.count)
+			return true;
+		e.chunks.values.reset();
+		e.chunks.current = e.chunks.count = 0;
+		return false;
+	}
+
+	inline void bind_grouping(statement &/*statement_*/, unsigned int &/*index*/)
+	{	}
+
+	template <typename T, typename... RestT>
+	inline void bind_grouping(statement &statement_, unsigned int &index, const T &/*order*/, const RestT &... rest)
+	{	bind_grouping(statement_, index, rest...);	}
+
+	template <typename... E, typename... RestT>
+	inline void bind_grouping(statement &statement_, unsigned int &index, const group_by_clause<E...> &group_by_,
+		const RestT &... rest)
+	{
+		row_value_binder<0, sizeof...(E)>::bind(statement_, group_by_.expressions, index);
+		bind_grouping(statement_, index, rest...);
+	}
+
+	template <typename E, typename... RestT>
+	inline void bind_grouping(statement &statement_, unsigned int &index, const having_clause<E> &having_,
+		const RestT &... rest)
+	{
+		bind_parameters(statement_, having_.condition, index);
+		bind_grouping(statement_, index, rest...);
+	}
+
+	inline void bind_modifiers(statement &/*statement_*/)
+	{	}
+
+	template <typename T, typename... RestT>
+	inline void bind_modifiers(statement &statement_, const T &/*order*/, const RestT &... rest)
+	{	bind_modifiers(statement_, rest...);	}
+
+	template <typename... RestT>
+	inline void bind_modifiers(statement &statement_, const limit_clause &limit_, const RestT &... rest)
+	{
+		statement_.bind(statement_.parameter_index(":limit"), limit_.value);
+		bind_modifiers(statement_, rest...);
+	}
+
+	template <typename... RestT>
+	inline void bind_modifiers(statement &statement_, const offset_clause &offset_, const RestT &... rest)
+	{
+		statement_.bind(statement_.parameter_index(":offset"), offset_.value);
+		bind_modifiers(statement_, rest...);
+	}
+
 	template <typename T, typename T2>
-	inline void bind_fields(statement &statement_, T2 &record)
+	inline int bind_fields(statement &statement_, T2 &record, int first_index = 1,
+		binding_lifetime lifetime = transient_binding)
 	{
-		field_binder<T> b = {	statement_, record, 1	};
+		field_binder<T> b = {	statement_, record, first_index, lifetime	};
 
 		describe<T>(b);
+		return b.index;
 	}
 
 	template <typename T, typename T2>
-	inline void bind_identity(sqlite3 &connection, T2 &record)
+	inline int bind_identity_fields(statement &statement_, const T2 &record, int first_index)
 	{
-		identity_binder<T2> b = {	connection, record	};
+		identity_field_binder<T2> b = {	statement_, record, first_index	};
 
 		describe<T>(b);
+		return b.index;
+	}
+
+	template <typename T, typename T2>
+	inline void bind_identity(std::int64_t rowid, T2 &record)
+	{
+		identity_binder<T2> b = {	rowid, record	};
+
+		describe<T>(b);
+	}
+
+	template <typename T, typename T2>
+	inline void bind_identity(sqlite3 &connection, T2 &record)
+	{	bind_identity<T>(sqlite3_last_insert_rowid(&connection), record);	}
+
+	template <typename T, typename F, typename U>
+	inline int field_binding_index(F U::*field)
+	{
+		field_index_visitor<T, F> v = {	field, 1, 0	};
+
+		describe<T>(v);
+		if (!v.found)
+			throw sql_error("The field is not described as a regular field of '" + default_table_name<T>() + "'");
+		return v.found;
 	}
 }
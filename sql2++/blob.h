@@ -0,0 +1,87 @@
+//	Copyright (c) 2011-2023 by Artem A. Gevorkyan (gevorkyan.org)
+//
+//	Permission is hereby granted, free of charge, to any person obtaining a copy
+//	of this software and associated documentation files (the "Software"), to deal
+//	in the Software without restriction, including without limitation the rights
+//	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//	copies of the Software, and to permit persons to whom the Software is
+//	furnished to do so, subject to the following conditions:
+//
+//	The above copyright notice and this permission notice shall be included in
+//	all copies or substantial portions of the Software.
+//
+//	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//	THE SOFTWARE.
+
+#pragma once
+
+#include "misc.h"
+#include "statement.h"
+
+#include <cstdint>
+#include <memory>
+
+namespace sql2xx
+{
+	struct blob_deleter
+	{
+		void operator ()(sqlite3_blob *ptr) const
+		{	sqlite3_blob_close(ptr);	}
+	};
+
+	// Incremental access to a single BLOB value. The handle must be destroyed before the owning transaction commits.
+	class blob_stream
+	{
+	public:
+		blob_stream(const connection_ptr &connection, const char *table, const char *column, std::int64_t rowid,
+			bool writable);
+
+		std::size_t size() const;
+		void read(std::size_t offset, void *buffer, std::size_t n) const;
+		void write(std::size_t offset, const void *buffer, std::size_t n);
+		void reopen(std::int64_t rowid);
+
+	private:
+		static void check(int result);
+
+	private:
+		connection_ptr _connection;
+		std::unique_ptr<sqlite3_blob, blob_deleter> _underlying;
+	};
+
+
+
+	inline blob_stream::blob_stream(const connection_ptr &connection, const char *table, const char *column,
+			std::int64_t rowid, bool writable)
+		: _connection(connection)
+	{
+		sqlite3_blob *p = nullptr;
+		const auto result = sqlite3_blob_open(_connection.get(), "main", table, column, rowid, writable ? 1 : 0, &p);
+
+		_underlying.reset(p);
+		check(result);
+	}
+
+	inline std::size_t blob_stream::size() const
+	{	return static_cast<std::size_t>(sqlite3_blob_bytes(_underlying.get()));	}
+
+	inline void blob_stream::read(std::size_t offset, void *buffer, std::size_t n) const
+	{	check(sqlite3_blob_read(_underlying.get(), buffer, static_cast<int>(n), static_cast<int>(offset)));	}
+
+	inline void blob_stream::write(std::size_t offset, const void *buffer, std::size_t n)
+	{	check(sqlite3_blob_write(_underlying.get(), buffer, static_cast<int>(n), static_cast<int>(offset)));	}
+
+	inline void blob_stream::reopen(std::int64_t rowid)
+	{	check(sqlite3_blob_reopen(_underlying.get(), rowid));	}
+
+	inline void blob_stream::check(int result)
+	{
+		if (SQLITE_OK != result)
+			throw execution_error(result);
+	}
+}
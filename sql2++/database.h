@@ -20,7 +20,10 @@
 
 #pragma once
 
+#include "blob.h"
 #include "insert.h"
+#include "plan.h"
+#include "pool.h"
 #include "remove.h"
 #include "select.h"
 #include "update.h"
@@ -28,20 +31,15 @@
 
 namespace sql2xx
 {
-	struct sql_error : std::runtime_error
-	{
-		sql_error(const std::string &text);
-
-		static void check_step(const connection_ptr &connection, int step_result);
-	};
-
 	class transaction
 	{
 	public:
 		enum type {	deferred, immediate, exclusive,	};
 
 	public:
-		transaction(connection_ptr connection, type type_ = deferred, int timeout_ms = 30000);
+		// A non-negative timeout_ms replaces the busy timeout the connection was configured with.
+		transaction(connection_ptr connection, type type_ = deferred, int timeout_ms = -1);
+		transaction(const connection_lease &lease, type type_ = deferred, int timeout_ms = -1);
 		~transaction();
 
 		template <typename T>
@@ -53,6 +51,9 @@ namespace sql2xx
 		template <typename T, typename T2, typename R, typename... OrderT>
 		reader<T> select(const wrapped<T2, R> &where, OrderT&&... order);
 
+		template <typename E, typename R, typename... RestE, typename... RestR>
+		projection_builder<R, RestR...> select(const wrapped<E, R> &first, const wrapped<RestE, RestR> &... rest);
+
 		template <typename T>
 		std::size_t count();
 
@@ -66,20 +67,61 @@ namespace sql2xx
 		inserter<T> upsert();
 
 		template <typename T, typename W, typename FieldT, typename U, typename ValueT, typename... RestT>
-		updater update(const W& where, FieldT U::*field, const ValueT &value, RestT &&...);
+		typename updater_type<W, ValueT, RestT...>::type update(const W& where, FieldT U::*field, const ValueT &value,
+			RestT &&...);
 
 		template <typename T, typename W>
-		remover remove(const W &where);
+		remover<W> remove(const W &where);
+
+		template <typename T, typename W, typename FieldT, typename U, typename ValueT, typename... RestT>
+		reader<T> update_returning(const W& where, FieldT U::*field, const ValueT &value, RestT &&...);
+
+		template <typename T, typename W>
+		reader<T> remove_returning(const W &where);
+
+		template <typename T, typename IteratorT>
+		std::size_t update_records(IteratorT begin_, IteratorT end_);
+
+		template <typename T, typename ContainerT>
+		std::size_t update_records(const ContainerT &records);
+
+		template <typename T, typename IteratorT>
+		std::size_t remove_records(IteratorT begin_, IteratorT end_);
+
+		template <typename T, typename ContainerT>
+		std::size_t remove_records(const ContainerT &records);
+
+		template <typename T, typename F, typename U>
+		blob_stream open_blob(F U::*field, std::int64_t rowid, bool writable = false);
+
+		template <typename T, typename T2, typename F, typename U>
+		blob_stream insert_zeroblob(T2 &record, F U::*field, std::size_t size);
+
+		query_plan explain(const char *expression_text);
+
+		template <typename T>
+		query_plan explain_select();
+
+		template <typename T, typename T2, typename R, typename... OrderT>
+		query_plan explain_select(const wrapped<T2, R> &where, OrderT&&... order);
+
+		template <typename T, typename W>
+		query_plan explain_count(const W &where);
+
+		template <typename T, typename W, typename FieldT, typename U, typename ValueT, typename... RestT>
+		query_plan explain_update(const W& where, FieldT U::*field, const ValueT &value, RestT &&...);
+
+		template <typename T, typename W>
+		query_plan explain_remove(const W &where);
 
 		void commit();
 
 	private:
+		void begin(type type_, int timeout_ms);
 		void execute(const char *sql_statemet);
 
-		template <typename T>
-		std::string create_insert_statement();
-
 	private:
+		std::shared_ptr<void> _lease;
 		connection_ptr _connection;
 		bool _comitted;
 	};
@@ -88,12 +130,11 @@ namespace sql2xx
 
 	inline transaction::transaction(connection_ptr connection, type type_, int timeout_ms)
 		: _connection(connection), _comitted(false)
-	{
-		const char *begin_sql[] = {	"BEGIN DEFERRED", "BEGIN IMMEDIATE", "BEGIN EXCLUSIVE",	};
+	{	begin(type_, timeout_ms);	}
 
-		sqlite3_busy_timeout(_connection.get(), timeout_ms);
-		execute(begin_sql[type_]);
-	}
+	inline transaction::transaction(const connection_lease &lease, type type_, int timeout_ms)
+		: _lease(lease.token()), _connection(lease.connection()), _comitted(false)
+	{	begin(type_, timeout_ms);	}
 
 	inline transaction::~transaction()
 	{
@@ -110,27 +151,36 @@ namespace sql2xx
 	inline void transaction::create_table()
 	{
 		std::string create_table_ddl;
+		std::vector<std::string> create_indices_ddl;
 
 		format_create_table<T>(create_table_ddl, default_table_name<T>().c_str());
 		execute(create_table_ddl.c_str());
+		format_create_indices<T>(create_indices_ddl, default_table_name<T>().c_str());
+		for (auto i = create_indices_ddl.begin(); i != create_indices_ddl.end(); ++i)
+			execute(i->c_str());
 	}
 
 	template <typename T>
 	inline reader<T> transaction::select()
-	{	return select_builder<T>().create_reader(*_connection);	}
+	{	return select_builder<T>().create_reader(_connection);	}
 
 	template <typename T, typename T2, typename R, typename... OrderT>
 	inline reader<T> transaction::select(const wrapped<T2, R> &where, OrderT&&... order)
-	{	return select_builder<T>().create_reader(*_connection, where, std::forward<OrderT>(order)...);	}
+	{	return select_builder<T>().create_reader(_connection, where, std::forward<OrderT>(order)...);	}
 
-	template <typename T>
-	std::size_t transaction::count()
+	template <typename E, typename R, typename... RestE, typename... RestR>
+	inline projection_builder<R, RestR...> transaction::select(const wrapped<E, R> &first,
+		const wrapped<RestE, RestR> &... rest)
 	{
-		std::string expression_text = "SELECT COUNT(*) FROM ";
+		typedef typename first_expression_table<E, RestE...>::type table_type;
 
-		format_table_source(expression_text, static_cast<T *>(nullptr));
+		return projection_builder<R, RestR...>(_connection, static_cast<table_type *>(nullptr), first, rest...);
+	}
 
-		statement stmt(create_statement(*_connection, expression_text.c_str()));
+	template <typename T>
+	std::size_t transaction::count()
+	{
+		statement stmt(create_statement(_connection, static_text< format_count<T> >().c_str()));
 
 		stmt.execute();
 		return static_cast<std::size_t>(static_cast<std::uint64_t>(stmt.get(0)));
@@ -139,96 +189,219 @@ namespace sql2xx
 	template <typename T, typename W>
 	std::size_t transaction::count(const W &where)
 	{
-		std::string expression_text = "SELECT COUNT(*) FROM ";
+		auto expression_text = static_text< format_count<T> >();
 
-		format_table_source(expression_text, static_cast<T *>(nullptr));
 		expression_text += " WHERE ";
 		format_expression(expression_text, where);
 
-		statement stmt(create_statement(*_connection, expression_text.c_str()));
+		statement stmt(create_statement(_connection, expression_text.c_str()));
+		const W w(where);
+		std::size_t n = 0;
 
-		bind_parameters(stmt, where);
-		stmt.execute();
-		return static_cast<std::size_t>(static_cast<std::uint64_t>(stmt.get(0)));
+		allow_in_chunks(w);
+		do
+		{
+			bind_parameters(stmt, w);
+			stmt.execute();
+			n += static_cast<std::size_t>(static_cast<std::uint64_t>(stmt.get(0)));
+			stmt.reset();
+		} while (next_in_chunk(w));
+		return n;
 	}
 
 
 	template <typename T>
 	inline inserter<T> transaction::insert()
-	{	return inserter<T>(*_connection, create_statement(*_connection, create_insert_statement<T>().c_str()));	}
+	{
+		return inserter<T>(_connection, create_statement(_connection, static_text< format_insert<T> >().c_str()),
+			&format_insert<T>);
+	}
 
 	template <typename T>
 	inline inserter<T> transaction::upsert()
 	{
-		auto request = create_insert_statement<T>() + " ON CONFLICT DO UPDATE SET ";
+		return inserter<T>(_connection, create_statement(_connection, static_text< format_upsert<T> >().c_str()),
+			&format_upsert<T>, true);
+	}
 
-		describe<T>(collect_regular_field_names([&] (const char *name, bool first) {
-			if (!first)
-				request += ',';
-			request += name;
-			request += "=EXCLUDED.";
-			request += name;
-		}));
-		return inserter<T>(*_connection, create_statement(*_connection, request.c_str()));
+	template <typename T, typename W, typename FieldT, typename U, typename ValueT, typename... RestT>
+	inline typename updater_type<W, ValueT, RestT...>::type transaction::update(const W &where, FieldT U:: *field,
+		const ValueT &value, RestT &&... rest)
+	{
+		typedef updater_type<W, ValueT, RestT...> type;
+		const typename type::bindings bindings = {	where, type::values::collect(std::tie(value), rest...),
+			in_operand_assigned(where, field, value, rest...)	};
+
+		return typename type::type(create_statement(_connection,
+			update_builder<T>(where, field, value, rest...).expression_text().c_str()), bindings);
 	}
 
+	template <typename T, typename W>
+	inline remover<W> transaction::remove(const W &where)
+	{	return remove_builder(default_table_name<T>().c_str()).create_statement(_connection, where);	}
+
 	template <typename T, typename W, typename FieldT, typename U, typename ValueT, typename... RestT>
-	inline updater transaction::update(const W &where, FieldT U:: *field, const ValueT &value, RestT &&... rest)
-	{	return update_builder<T>(where, field, value, std::forward<RestT>(rest)...).create(*_connection);	}
+	inline reader<T> transaction::update_returning(const W &where, FieldT U:: *field, const ValueT &value,
+		RestT &&... rest)
+	{
+		typedef updater_type<W, ValueT, RestT...> type;
+		const typename type::bindings bindings = {	where, type::values::collect(std::tie(value), rest...),
+			in_operand_assigned(where, field, value, rest...)	};
+		auto expression_text = update_builder<T>(where, field, value, rest...).expression_text();
+
+		format_returning<T>(expression_text);
+		return reader<T>(create_statement(_connection, expression_text.c_str()), bindings);
+	}
 
 	template <typename T, typename W>
-	inline remover transaction::remove(const W &where)
-	{	return remove_builder(default_table_name<T>().c_str()).create_statement(*_connection, where);	}
+	inline reader<T> transaction::remove_returning(const W &where)
+	{
+		auto expression_text = remove_builder(default_table_name<T>().c_str()).expression_text(where);
 
-	inline void transaction::commit()
+		format_returning<T>(expression_text);
+		return reader<T>(create_statement(_connection, expression_text.c_str()), where);
+	}
+
+	template <typename T, typename IteratorT>
+	inline std::size_t transaction::update_records(IteratorT begin_, IteratorT end_)
 	{
-		execute("COMMIT");
-		_comitted = true;
+		auto identity_fields = 0, regular_fields = 0;
+
+		describe<T>(collect_identity_field_names([&] (const char *, bool) {	identity_fields++;	}));
+		if (!identity_fields)
+			throw sql_error("Records of '" + default_table_name<T>() + "' cannot be updated: no identity field is described");
+		describe<T>(collect_regular_field_names([&] (const char *, bool) {	regular_fields++;	}));
+		if (!regular_fields)
+			throw sql_error("Records of '" + default_table_name<T>() + "' cannot be updated: only identity is described");
+
+		statement stmt(create_statement(_connection, static_text< format_update_by_identity<T> >().c_str()));
+		std::size_t changed = 0;
+
+		try
+		{
+			for (auto i = begin_; i != end_; ++i)
+			{
+				bind_identity_fields<T>(stmt, *i, bind_fields<T>(stmt, *i, 1, static_binding));
+				stmt.execute();
+				changed += static_cast<std::size_t>(stmt.changes());
+				stmt.reset();
+			}
+		}
+		catch (...)
+		{
+			stmt.reset(); // Text fields are bound without copying: drop the references to the record.
+			throw;
+		}
+		return changed;
 	}
 
-	inline void transaction::execute(const char *sql_statemet)
-	try
+	template <typename T, typename ContainerT>
+	inline std::size_t transaction::update_records(const ContainerT &records)
+	{	return update_records<T>(std::begin(records), std::end(records));	}
+
+	template <typename T, typename IteratorT>
+	inline std::size_t transaction::remove_records(IteratorT begin_, IteratorT end_)
 	{
-		statement stmt(create_statement(*_connection, sql_statemet));
+		auto identity_fields = 0;
 
-		stmt.execute();
+		describe<T>(collect_identity_field_names([&] (const char *, bool) {	identity_fields++;	}));
+		if (!identity_fields)
+			throw sql_error("Records of '" + default_table_name<T>() + "' cannot be removed: no identity field is described");
+
+		statement stmt(create_statement(_connection, static_text< format_remove_by_identity<T> >().c_str()));
+		std::size_t removed = 0;
+
+		for (auto i = begin_; i != end_; ++i)
+		{
+			bind_identity_fields<T>(stmt, *i, 1);
+			stmt.execute();
+			removed += static_cast<std::size_t>(stmt.changes());
+			stmt.reset();
+		}
+		return removed;
 	}
-	catch (execution_error &e)
+
+	template <typename T, typename ContainerT>
+	inline std::size_t transaction::remove_records(const ContainerT &records)
+	{	return remove_records<T>(std::begin(records), std::end(records));	}
+
+	template <typename T, typename F, typename U>
+	inline blob_stream transaction::open_blob(F U::*field, std::int64_t rowid, bool writable)
 	{
-		sql_error::check_step(_connection, e.code);
+		std::string column_name;
+		format_column_visitor<T, F> v = {	field, &column_name	};
+
+		describe<T>(v);
+		return blob_stream(_connection, default_table_name<T>().c_str(), column_name.c_str(), rowid, writable);
 	}
 
+	template <typename T, typename T2, typename F, typename U>
+	inline blob_stream transaction::insert_zeroblob(T2 &record, F U::*field, std::size_t size)
+	{
+		statement stmt(create_statement(_connection, static_text< format_insert<T> >().c_str()));
+
+		bind_fields<T>(stmt, record, 1, static_binding);
+		stmt.bind_zeroblob(field_binding_index<T>(field), size);
+		stmt.execute();
+		bind_identity<T>(*_connection, record);
+		return open_blob<T>(field, sqlite3_last_insert_rowid(_connection.get()), true);
+	}
+
+	inline query_plan transaction::explain(const char *expression_text)
+	{	return explain_query_plan(*_connection, expression_text);	}
+
 	template <typename T>
-	inline std::string transaction::create_insert_statement()
+	inline query_plan transaction::explain_select()
+	{	return explain(select_builder<T>().expression_text().c_str());	}
+
+	template <typename T, typename T2, typename R, typename... OrderT>
+	inline query_plan transaction::explain_select(const wrapped<T2, R> &where, OrderT&&... order)
+	{	return explain(select_builder<T>().expression_text(where, std::forward<OrderT>(order)...).c_str());	}
+
+	template <typename T, typename W>
+	inline query_plan transaction::explain_count(const W &where)
 	{
-		auto request = "INSERT INTO " + default_table_name<T>() + " (";
+		auto expression_text = static_text< format_count<T> >();
 
-		describe<T>(collect_regular_field_names([&] (const char *name, bool first) {
-			if (!first)
-				request += ',';
-			request += name;
-		}));
-		request += ") VALUES (";
-		describe<T>(collect_regular_field_names([&] (const char *, bool first) {
-			if (!first)
-				request += ',';
-			request += '?';
-		}));
-		request += ") ";
-		return request;
+		expression_text += " WHERE ";
+		format_expression(expression_text, where);
+		return explain(expression_text.c_str());
 	}
 
+	template <typename T, typename W, typename FieldT, typename U, typename ValueT, typename... RestT>
+	inline query_plan transaction::explain_update(const W &where, FieldT U:: *field, const ValueT &value, RestT &&... rest)
+	{
+		return explain(update_builder<T>(where, field, value, std::forward<RestT>(rest)...).expression_text().c_str());
+	}
 
-	inline sql_error::sql_error(const std::string &text)
-		: std::runtime_error(text)
-	{	}
+	template <typename T, typename W>
+	inline query_plan transaction::explain_remove(const W &where)
+	{	return explain(remove_builder(default_table_name<T>().c_str()).expression_text(where).c_str());	}
+
+	inline void transaction::commit()
+	{
+		execute("COMMIT");
+		_comitted = true;
+	}
 
-	inline void sql_error::check_step(const connection_ptr &connection, int /*step_result*/)
+	inline void transaction::begin(type type_, int timeout_ms)
 	{
-		std::string text = "SQLite error: ";
-			
-		text += sqlite3_errmsg(connection.get());
-		text += "!";
-		throw sql_error(text);
+		const char *begin_sql[] = {	"BEGIN DEFERRED", "BEGIN IMMEDIATE", "BEGIN EXCLUSIVE",	};
+
+		if (timeout_ms >= 0)
+			sqlite3_busy_timeout(_connection.get(), timeout_ms);
+		execute(begin_sql[type_]);
+	}
+
+	inline void transaction::execute(const char *sql_statemet)
+	try
+	{
+		statement stmt(create_statement(*_connection, sql_statemet)); // Transaction control and DDL bypass the cache.
+
+		stmt.execute();
+	}
+	catch (execution_error &e)
+	{
+		sql_error::check_step(_connection, e.code);
 	}
 }
@@ -22,6 +22,13 @@
 
 #include "nullable.h"
 
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sqlite3.h>
+#include <string>
+#include <tuple>
 #include <type_traits>
 
 namespace sql2xx
@@ -44,6 +51,14 @@ namespace sql2xx
 		T &object;
 	};
 
+	template <typename T>
+	struct literal
+	{
+		typedef T result_type;
+
+		T value;
+	};
+
 	template <typename T, typename F>
 	struct column
 	{
@@ -89,6 +104,117 @@ namespace sql2xx
 		const char* literal_postfix;
 	};
 
+	enum in_binding {	json_array_binding, parameter_list_binding	};
+
+	// The state of an IN list bound in chunks (see in()). It is kept by the copy of the condition a statement is bound
+	// from, the statement being executed once per chunk.
+	struct in_list_chunks
+	{
+		bool allowed; // The list is only AND-ed with the rest of the condition: see allow_in_chunks().
+		std::size_t current, count;
+		std::shared_ptr<const void> values; // Distinct values of the container, shared by the chunks.
+	};
+
+	template <typename E, typename ContainerT>
+	struct in_predicate
+	{
+		typedef bool result_type;
+
+		E operand;
+		const ContainerT &values;
+		in_binding binding;
+		std::size_t list_size; // Parameters the list is formatted with (parameter_list_binding only).
+		mutable in_list_chunks chunks;
+
+		decltype(typename remove_nullable<typename E::result_type>::type()
+			== typename ContainerT::value_type()) __validity;
+	};
+
+	template <typename... E>
+	struct row_value
+	{
+		typedef std::tuple<typename E::result_type...> result_type;
+
+		std::tuple<E...> elements;
+	};
+
+	template <typename E, typename R>
+	struct aggregate
+	{
+		typedef R result_type;
+
+		E operand;
+		const char *function;
+		const char *separator; // group_concat() only.
+	};
+
+	struct count_all
+	{
+		typedef std::int64_t result_type;
+	};
+
+	struct rowid_column
+	{
+		typedef std::int64_t result_type;
+	};
+
+	template <typename... E>
+	struct group_by_clause
+	{
+		std::tuple<E...> expressions;
+	};
+
+	template <typename E>
+	struct having_clause
+	{
+		E condition;
+	};
+
+	template <typename E>
+	struct expression_table {	typedef void type;	};
+
+	template <typename T, typename F>
+	struct expression_table< column<T, F> > {	typedef T type;	};
+
+	template <typename E, typename R>
+	struct expression_table< aggregate<E, R> > {	typedef typename expression_table<E>::type type;	};
+
+	template <typename L, typename R>
+	struct expression_table< binary_operator<L, R> >
+	{
+		typedef typename expression_table<L>::type lhs_table;
+		typedef typename std::conditional<std::is_void<lhs_table>::value,
+			typename expression_table<R>::type, lhs_table>::type type;
+	};
+
+	template <typename U>
+	struct expression_table< unary_operator<U> > {	typedef typename expression_table<U>::type type;	};
+
+	template <typename E, typename R>
+	struct expression_table< wrapped<E, R> > {	typedef typename expression_table<E>::type type;	};
+
+	// The table of the first expression that refers to one.
+	template <typename... E>
+	struct first_expression_table {	typedef void type;	};
+
+	template <typename E, typename... RestE>
+	struct first_expression_table<E, RestE...>
+	{
+		typedef typename expression_table<E>::type table_type;
+		typedef typename std::conditional<std::is_void<table_type>::value,
+			typename first_expression_table<RestE...>::type, table_type>::type type;
+	};
+
+	struct limit_clause
+	{
+		std::int64_t value;
+	};
+
+	struct offset_clause
+	{
+		std::int64_t value;
+	};
+
 
 
 	template <typename T>
@@ -116,6 +242,20 @@ namespace sql2xx
 		return wrap(param);
 	}
 
+	// A constant formatted into the expression text (e.g. for partial index definitions, where parameters are not allowed).
+	template <typename T>
+	inline wrapped< literal<T> > lit(const T &value)
+	{
+		literal<T> l = {	value	};
+		return wrap(l);
+	}
+
+	inline wrapped< literal<std::string> > lit(const char *value)
+	{
+		literal<std::string> l = {	value	};
+		return wrap(l);
+	}
+
 	template <typename L, typename R, typename T1, typename T2>
 	inline wrapped< binary_operator<L, R> > operator ==(const wrapped<L, T1> &lhs, const wrapped<R, T2> &rhs)
 	{
@@ -172,6 +312,160 @@ namespace sql2xx
 		return wrap(o);
 	}
 
+	inline in_binding default_in_binding()
+	{
+		static const auto json = sqlite3_libversion_number() >= 3038000 && !sqlite3_compileoption_used("OMIT_JSON");
+
+		return json ? json_array_binding : parameter_list_binding;
+	}
+
+	// The largest number of parameters an IN list is formatted with: a power of two no greater than half of the
+	// SQLITE_MAX_VARIABLE_NUMBER the SQLite library is built with (the default of its version, unless set at build time),
+	// leaving the rest to other parameters of a statement. Lists are formatted before a statement is prepared on a
+	// connection, so a limit lowered on a particular connection is not accounted for.
+	inline std::size_t max_in_list_parameters()
+	{
+		static const auto limit = [] () -> std::size_t {
+			const char option[] = "MAX_VARIABLE_NUMBER=";
+			auto variables = sqlite3_libversion_number() >= 3032000 ? 32766 : 999;
+			std::size_t size = 1;
+
+			for (auto i = 0; sqlite3_compileoption_get(i); ++i)
+			{
+				if (!std::strncmp(sqlite3_compileoption_get(i), option, sizeof(option) - 1))
+					variables = std::atoi(sqlite3_compileoption_get(i) + sizeof(option) - 1);
+			}
+			while (2 * size <= static_cast<std::size_t>(variables) / 2)
+				size <<= 1;
+			return size;
+		}();
+
+		return limit;
+	}
+
+	inline std::size_t in_parameter_list_size(std::size_t n)
+	{
+		const auto limit = max_in_list_parameters();
+		std::size_t size = n ? 1 : 0;
+
+		while (size < n && size < limit)
+			size <<= 1;
+		return size;
+	}
+
+	// 'operand IN (...)' over the values of a container (referenced, like a parameter). With json_array_binding the
+	// values are bound at once as a JSON array, otherwise they are bound to a list of parameters, padded to a power of
+	// two, so that statements for different container sizes can be reused. The list is sized for the values the
+	// container has when 'in' is called, up to max_in_list_parameters(): if there are more of them when the statement
+	// is bound, they are made distinct and bound in chunks of that size, the statement being executed once per chunk.
+	// Such an 'in' may only be AND-ed with the rest of a condition, and cannot be used in ordered, limited or
+	// projecting selects, or in updates assigning the field it is over. A container cannot become empty (or stop being
+	// empty) once the list is formatted.
+	template <typename E, typename R, typename ContainerT>
+	inline wrapped< in_predicate<E, ContainerT> > in(const wrapped<E, R> &operand, const ContainerT &values,
+		in_binding binding = default_in_binding())
+	{
+		in_predicate<E, ContainerT> i = {	operand, values, binding,
+			binding == parameter_list_binding ? in_parameter_list_size(values.size()) : 0	};
+		return wrap(i);
+	}
+
+	// A row value, e.g. 'row(c(&T::a), c(&T::b)) > row(p(x), p(y))' formats as '((a,b)>(:1,:2))'.
+	template <typename... E, typename... R>
+	inline wrapped< row_value<E...> > row(const wrapped<E, R> &... elements)
+	{
+		row_value<E...> r = {	std::tuple<E...>(elements...)	};
+		return wrap(r);
+	}
+
+	// Keyset pagination: a predicate selecting rows following 'last' when ordered ascending by the fields specified.
+	template <typename T, typename... F>
+	inline auto seek_after(const T &last, F T::*... fields) -> decltype(row(c(fields)...) > row(p(last.*fields)...))
+	{	return row(c(fields)...) > row(p(last.*fields)...);	}
+
+	// Keyset pagination: same as seek_after(), but for descending order.
+	template <typename T, typename... F>
+	inline auto seek_before(const T &last, F T::*... fields) -> decltype(row(c(fields)...) < row(p(last.*fields)...))
+	{	return row(c(fields)...) < row(p(last.*fields)...);	}
+
+	template <typename E, typename R>
+	inline wrapped< aggregate<E, typename std::conditional<std::is_floating_point<typename remove_nullable<R>::type>::value,
+		double, std::int64_t>::type> > sum(const wrapped<E, R> &operand)
+	{
+		typedef typename std::conditional<std::is_floating_point<typename remove_nullable<R>::type>::value,
+			double, std::int64_t>::type result_type;
+
+		aggregate<E, result_type> a = {	operand, "SUM", nullptr	};
+		return wrap(a);
+	}
+
+	template <typename E, typename R>
+	inline wrapped< aggregate<E, typename remove_nullable<R>::type> > min(const wrapped<E, R> &operand)
+	{
+		aggregate<E, typename remove_nullable<R>::type> a = {	operand, "MIN", nullptr	};
+		return wrap(a);
+	}
+
+	template <typename E, typename R>
+	inline wrapped< aggregate<E, typename remove_nullable<R>::type> > max(const wrapped<E, R> &operand)
+	{
+		aggregate<E, typename remove_nullable<R>::type> a = {	operand, "MAX", nullptr	};
+		return wrap(a);
+	}
+
+	template <typename E, typename R>
+	inline wrapped< aggregate<E, double> > avg(const wrapped<E, R> &operand)
+	{
+		aggregate<E, double> a = {	operand, "AVG", nullptr	};
+		return wrap(a);
+	}
+
+	template <typename E, typename R>
+	inline wrapped< aggregate<E, std::int64_t> > count(const wrapped<E, R> &operand)
+	{
+		aggregate<E, std::int64_t> a = {	operand, "COUNT", nullptr	};
+		return wrap(a);
+	}
+
+	inline wrapped<count_all> count()
+	{	return wrap(count_all());	}
+
+	inline wrapped<rowid_column> rowid()
+	{	return wrap(rowid_column());	}
+
+	template <typename E, typename R>
+	inline wrapped< aggregate<E, std::string> > group_concat(const wrapped<E, R> &operand, const char *separator = nullptr)
+	{
+		aggregate<E, std::string> a = {	operand, "GROUP_CONCAT", separator	};
+		return wrap(a);
+	}
+
+	template <typename... E, typename... R>
+	inline group_by_clause<E...> group_by(const wrapped<E, R> &... expressions)
+	{
+		group_by_clause<E...> g = {	std::tuple<E...>(expressions...)	};
+		return g;
+	}
+
+	template <typename E>
+	inline having_clause<E> having(const wrapped<E, bool> &condition)
+	{
+		having_clause<E> h = {	condition	};
+		return h;
+	}
+
+	inline limit_clause limit(std::int64_t value)
+	{
+		limit_clause l = {	value	};
+		return l;
+	}
+
+	inline offset_clause offset(std::int64_t value)
+	{
+		offset_clause o = {	value	};
+		return o;
+	}
+
 	template <typename U, typename T>
 	inline wrapped< unary_operator<U> > is_null(const wrapped< U, nullable<T> > &operand)
 	{
@@ -23,10 +23,13 @@
 #include "expression.h"
 #include "nullable.h"
 #include "types.h"
+#include "view.h"
 #include "visitor.h"
 
 #include <algorithm>
+#include <cfloat>
 #include <cstdint>
+#include <cstdio>
 #include <list>
 #include <string>
 #include <tuple>
@@ -73,6 +76,28 @@ namespace sql2xx
 	};
 
 
+	struct index_definition
+	{
+		std::vector<std::string> columns; // 'column' or 'column DESC'.
+		std::string where;
+	};
+
+	template <typename T>
+	struct index_fields_collector
+	{
+		template <typename U>
+		index_fields_collector<T> operator <<(U T::*field) const;
+
+		template <typename U>
+		index_fields_collector<T> operator <<(descending<U T::*> field) const;
+
+		template <typename E>
+		index_fields_collector<T> operator <<(const wrapped<E, bool> &where) const;
+
+		index_definition &definition;
+	};
+
+
 	template <typename T, typename ReferredT>
 	struct fk_pk_fields_collector;
 
@@ -121,9 +146,18 @@ namespace sql2xx
 		void operator ()(std::string T::*, const char *column_name)
 		{	append_text(column_name); not_null();	}
 
+		void operator ()(text_view T::*, const char *column_name)
+		{	append_text(column_name); not_null();	}
+
 		void operator ()(double T::*, const char *column_name)
 		{	append_real(column_name); not_null();	}
 
+		void operator ()(std::vector<std::uint8_t> T::*, const char *column_name)
+		{	append_blob(column_name); not_null();	}
+
+		void operator ()(blob_view T::*, const char *column_name)
+		{	append_blob(column_name); not_null();	}
+
 		void operator ()(nullable<int> T::*, const char *column_name)
 		{	append_integer(column_name);	}
 
@@ -139,9 +173,18 @@ namespace sql2xx
 		void operator ()(nullable<std::string> T::*, const char *column_name)
 		{	append_text(column_name);	}
 
+		void operator ()(nullable<text_view> T::*, const char *column_name)
+		{	append_text(column_name);	}
+
 		void operator ()(nullable<double> T::*, const char *column_name)
 		{	append_real(column_name);	}
 
+		void operator ()(nullable< std::vector<std::uint8_t> > T::*, const char *column_name)
+		{	append_blob(column_name);	}
+
+		void operator ()(nullable<blob_view> T::*, const char *column_name)
+		{	append_blob(column_name);	}
+
 		template <typename F>
 		void operator ()(identity_tag, F field, const char *column_name)
 		{
@@ -177,6 +220,9 @@ namespace sql2xx
 			return v;
 		}
 
+		nil_stream operator <<(index_tag) const
+		{	return nil_stream();	}
+
 		std::string &column_definitions;
 		std::list< std::tuple< std::string, std::vector<std::string> > > &constraints;
 		std::list<foreign_key_constraint> &foreign_key_constraints;
@@ -204,6 +250,38 @@ namespace sql2xx
 
 		void append_real(const char *column_name)
 		{	append_column(column_name) += " REAL";	}
+
+		void append_blob(const char *column_name)
+		{	append_column(column_name) += " BLOB";	}
+	};
+
+
+	template <typename T>
+	struct index_definition_visitor
+	{
+		template <typename U>
+		void operator ()(U) const
+		{	}
+
+		template <typename U, typename V>
+		void operator ()(U, V) const
+		{	}
+
+		template <typename TagT, typename U, typename V>
+		void operator ()(TagT, U, V) const
+		{	}
+
+		template <typename TagT>
+		nil_stream operator <<(TagT) const
+		{	return nil_stream();	}
+
+		index_fields_collector<T> operator <<(index_tag) const
+		{
+			index_fields_collector<T> collector = {	*indices.insert(indices.end(), index_definition())	};
+			return collector;
+		}
+
+		std::list<index_definition> &indices;
 	};
 
 
@@ -249,39 +327,87 @@ namespace sql2xx
 		return r;
 	}
 
-	template <unsigned int table_index> inline void table_alias(std::string &output);
-	template <> inline void table_alias<0>(std::string &output) {	output += "t0";	}
-	template <> inline void table_alias<1>(std::string &output) {	output += "t1";	}
-	template <> inline void table_alias<2>(std::string &output) {	output += "t2";	}
-	template <> inline void table_alias<3>(std::string &output) {	output += "t3";	}
+	template <unsigned int n>
+	struct decimal_digits
+	{
+		static void append(std::string &output)
+		{
+			decimal_digits<n / 10>::append(output);
+			output += static_cast<char>('0' + n % 10);
+		}
+	};
 
-	template <typename T>
-	inline void format_table_source(std::string &output, T *)
+	template <>
+	struct decimal_digits<0>
 	{
-		table_source_visitor v = {	output	};
+		static void append(std::string &/*output*/)
+		{	}
+	};
 
-		describe<T>(v);
+	// 't0', 't1', ... - aliases of the tables joined, spelled out at compile time.
+	template <unsigned int table_index>
+	inline void table_alias(std::string &output)
+	{
+		output += 't';
+		if (table_index)
+			decimal_digits<table_index>::append(output);
+		else
+			output += '0';
 	}
 
-	template <typename T1, typename T2>
-	inline void format_table_source(std::string &output, std::tuple<T1, T2> *)
+	template <std::size_t i, std::size_t n>
+	struct joined_tables_formatter
 	{
-		table_source_visitor v = {	output	};
+		template <typename TupleT>
+		static void format_source(std::string &output)
+		{
+			table_source_visitor v = {	output	};
 
-		describe<T1>(v), output += " AS ", table_alias<0>(output), output += ",";
-		describe<T2>(v), output += " AS ", table_alias<1>(output);
-	}
+			if (i)
+				output += ',';
+			describe<typename std::tuple_element<i, TupleT>::type>(v);
+			output += " AS ", table_alias<i>(output);
+			joined_tables_formatter<i + 1, n>::template format_source<TupleT>(output);
+		}
+
+		template <typename TupleT>
+		static void format_select_list(std::string &output)
+		{
+			describe<typename std::tuple_element<i, TupleT>::type>(collect_all_field_names([&] (const char *name,
+				bool first) {
+
+				if (i || !first)
+					output += ',';
+				table_alias<i>(output), output += '.', output += name;
+			}));
+			joined_tables_formatter<i + 1, n>::template format_select_list<TupleT>(output);
+		}
+	};
+
+	template <std::size_t n>
+	struct joined_tables_formatter<n, n>
+	{
+		template <typename TupleT>
+		static void format_source(std::string &/*output*/)
+		{	}
+
+		template <typename TupleT>
+		static void format_select_list(std::string &/*output*/)
+		{	}
+	};
 
-	template <typename T1, typename T2, typename T3>
-	inline void format_table_source(std::string &output, std::tuple<T1, T2, T3> *)
+	template <typename T>
+	inline void format_table_source(std::string &output, T *)
 	{
 		table_source_visitor v = {	output	};
 
-		describe<T1>(v), output += " AS ", table_alias<0>(output), output += ",";
-		describe<T2>(v), output += " AS ", table_alias<1>(output), output += ",";
-		describe<T3>(v), output += " AS ", table_alias<2>(output);
+		describe<T>(v);
 	}
 
+	template <typename... T>
+	inline void format_table_source(std::string &output, std::tuple<T...> *)
+	{	joined_tables_formatter<0, sizeof...(T)>::template format_source< std::tuple<T...> >(output);	}
+
 
 	template <typename T>
 	inline void format_select_list(std::string &output, T *)
@@ -293,34 +419,9 @@ namespace sql2xx
 		}));
 	}
 
-	template <typename T1, typename T2>
-	inline void format_select_list(std::string &output, std::tuple<T1, T2> *)
-	{
-		describe<T1>(collect_all_field_names([&] (const char *name, bool first) {
-			if (!first)
-				output += ',';
-			output += "t0."; output += name;
-		}));
-		describe<T2>(collect_all_field_names([&] (const char *name, bool /*first*/) {
-			output += ",t1."; output += name;
-		}));
-	}
-
-	template <typename T1, typename T2, typename T3>
-	inline void format_select_list(std::string &output, std::tuple<T1, T2, T3> *)
-	{
-		describe<T1>(collect_all_field_names([&] (const char *name, bool first) {
-			if (!first)
-				output += ',';
-			output += "t0."; output += name;
-		}));
-		describe<T2>(collect_all_field_names([&] (const char *name, bool /*first*/) {
-			output += ",t1."; output += name;
-		}));
-		describe<T3>(collect_all_field_names([&] (const char *name, bool /*first*/) {
-			output += ",t2."; output += name;
-		}));
-	}
+	template <typename... T>
+	inline void format_select_list(std::string &output, std::tuple<T...> *)
+	{	joined_tables_formatter<0, sizeof...(T)>::template format_select_list< std::tuple<T...> >(output);	}
 
 
 	template <typename T, typename F>
@@ -345,6 +446,159 @@ namespace sql2xx
 	inline void format_expression(std::string &output, const prefixed_column<table_index, T, F> &e, unsigned int &/*index*/)
 	{	format_column(output, e);	}
 
+	template <typename T>
+	inline void format_literal(std::string &output, const T &value)
+	{	output += std::to_string(value);	}
+
+	inline void format_literal(std::string &output, bool value)
+	{	output += value ? '1' : '0';	}
+
+	inline void format_literal(std::string &output, double value)
+	{
+		char buffer[32];
+
+		std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+		output += buffer;
+	}
+
+	inline void format_literal(std::string &output, const std::string &value)
+	{
+		output += '\'';
+		for (auto i = value.begin(); i != value.end(); ++i)
+		{
+			if (*i == '\'')
+				output += '\'';
+			output += *i;
+		}
+		output += '\'';
+	}
+
+	template <std::size_t i, std::size_t n>
+	struct row_value_formatter
+	{
+		template <typename TupleT>
+		static void format(std::string &output, const TupleT &elements, unsigned int &index)
+		{
+			if (i)
+				output += ',';
+			format_expression(output, std::get<i>(elements), index);
+			row_value_formatter<i + 1, n>::format(output, elements, index);
+		}
+	};
+
+	template <std::size_t n>
+	struct row_value_formatter<n, n>
+	{
+		template <typename TupleT>
+		static void format(std::string &/*output*/, const TupleT &/*elements*/, unsigned int &/*index*/)
+		{	}
+	};
+
+	template <typename... E>
+	inline void format_expression(std::string &output, const row_value<E...> &e, unsigned int &index)
+	{
+		output += '(';
+		row_value_formatter<0, sizeof...(E)>::format(output, e.elements, index);
+		output += ')';
+	}
+
+	template <typename E, typename R>
+	inline void format_expression(std::string &output, const aggregate<E, R> &e, unsigned int &index)
+	{
+		output += e.function;
+		output += '(';
+		format_expression(output, e.operand, index);
+		if (e.separator)
+			output += ',', format_literal(output, std::string(e.separator));
+		output += ')';
+	}
+
+	inline void format_expression(std::string &output, const count_all &/*e*/, unsigned int &/*index*/)
+	{	output += "COUNT(*)";	}
+
+	inline void format_expression(std::string &output, const rowid_column &/*e*/, unsigned int &/*index*/)
+	{	output += "rowid";	}
+
+	template <typename E, typename ContainerT>
+	inline void format_expression(std::string &output, const in_predicate<E, ContainerT> &e, unsigned int &index)
+	{
+		output += '(';
+		format_expression(output, e.operand, index);
+		if (e.binding == json_array_binding)
+		{
+			output += " IN (SELECT value FROM json_each(:";
+			output += std::to_string((unsigned long long)index++);
+			output += "))";
+		}
+		else
+		{
+			output += " IN (";
+			for (auto n = e.list_size; n--; )
+			{
+				output += ':';
+				output += std::to_string((unsigned long long)index++);
+				if (n)
+					output += ',';
+			}
+			output += ')';
+		}
+		output += ')';
+	}
+
+	template <typename T>
+	inline void format_json_value(std::string &output, const T &value)
+	{	format_literal(output, value);	}
+
+	inline void format_json_value(std::string &output, double value)
+	{
+		if (value != value)
+			output += "null"; // NaN is stored as NULL, so it never matches.
+		else if (value > DBL_MAX || value < -DBL_MAX)
+			output += value > 0 ? "9e999" : "-9e999"; // JSON has no infinities, but these parse to them.
+		else
+			format_literal(output, value);
+	}
+
+	// Floats are bound widened to double, so it's the widened value that is formatted (at full precision).
+	inline void format_json_value(std::string &output, float value)
+	{	format_json_value(output, static_cast<double>(value));	}
+
+	inline void format_json_value(std::string &output, const std::string &value)
+	{
+		const char hex[] = "0123456789abcdef";
+
+		output += '"';
+		for (auto i = value.begin(); i != value.end(); ++i)
+		{
+			const auto c = static_cast<unsigned char>(*i);
+
+			if (c == '"' || c == '\\')
+				output += '\\', output += *i;
+			else if (c < 0x20)
+				output += "\\u00", output += hex[c >> 4], output += hex[c & 0xF];
+			else
+				output += *i;
+		}
+		output += '"';
+	}
+
+	template <typename ContainerT>
+	inline void format_json_array(std::string &output, const ContainerT &values)
+	{
+		output += '[';
+		for (auto i = std::begin(values); i != std::end(values); ++i)
+		{
+			if (i != std::begin(values))
+				output += ',';
+			format_json_value(output, *i);
+		}
+		output += ']';
+	}
+
+	template <typename T>
+	inline void format_expression(std::string &output, const literal<T> &e, unsigned int &/*index*/)
+	{	format_literal(output, e.value);	}
+
 	template <typename T>
 	inline void format_expression(std::string &output, const parameter<T> &/*e*/, unsigned int &index)
 	{
@@ -378,6 +632,15 @@ namespace sql2xx
 		format_expression(output, e, index);
 	}
 
+	inline void format_limit(std::string &output, const limit_clause &/*limit*/)
+	{	output += " LIMIT :limit";	}
+
+	inline void format_limit(std::string &output, const offset_clause &/*offset*/)
+	{	output += " LIMIT -1 OFFSET :offset";	}
+
+	inline void format_limit(std::string &output, const limit_clause &/*limit*/, const offset_clause &/*offset*/)
+	{	output += " LIMIT :limit OFFSET :offset";	}
+
 	template <typename ColT>
 	inline void format_order_one(std::string &output, const ColT &col, bool ascending)
 	{
@@ -407,6 +670,201 @@ namespace sql2xx
 		format_order_next(output, std::forward<RestT>(args)...);
 	}
 
+	template <typename... RestT>
+	inline void format_order_next(std::string &output, const limit_clause &limit_, RestT&&... args)
+	{	format_limit(output, limit_, std::forward<RestT>(args)...);	}
+
+	template <typename... RestT>
+	inline void format_order_next(std::string &output, const offset_clause &offset_, RestT&&... args)
+	{	format_limit(output, offset_, std::forward<RestT>(args)...);	}
+
+	template <typename... RestT>
+	inline void format_order(std::string &output, const limit_clause &limit_, RestT&&... args)
+	{	format_limit(output, limit_, std::forward<RestT>(args)...);	}
+
+	template <typename... RestT>
+	inline void format_order(std::string &output, const offset_clause &offset_, RestT&&... args)
+	{	format_limit(output, offset_, std::forward<RestT>(args)...);	}
+
+	template <typename... RestT>
+	inline void format_grouping(std::string &output, unsigned int &/*index*/, const RestT &... order)
+	{	format_order(output, order...);	}
+
+	template <typename... E, typename... RestT>
+	inline void format_grouping(std::string &output, unsigned int &index, const group_by_clause<E...> &group_by_,
+		const RestT &... rest)
+	{
+		output += " GROUP BY ";
+		row_value_formatter<0, sizeof...(E)>::format(output, group_by_.expressions, index);
+		format_grouping(output, index, rest...);
+	}
+
+	template <typename E, typename... RestT>
+	inline void format_grouping(std::string &output, unsigned int &index, const having_clause<E> &having_,
+		const RestT &... rest)
+	{
+		output += " HAVING ";
+		format_expression(output, having_.condition, index);
+		format_grouping(output, index, rest...);
+	}
+
+
+	template <typename T>
+	inline void format_select(std::string &output)
+	{
+		output += "SELECT ";
+		format_select_list(output, static_cast<T *>(nullptr));
+		output += " FROM ";
+		format_table_source(output, static_cast<T *>(nullptr));
+	}
+
+	inline void format_expression_list(std::string &/*output*/, unsigned int &/*index*/)
+	{	}
+
+	template <typename E, typename... RestE>
+	inline void format_expression_list(std::string &output, unsigned int &index, const E &e, const RestE &... rest)
+	{
+		output += ',';
+		format_expression(output, e, index);
+		format_expression_list(output, index, rest...);
+	}
+
+	template <typename T, typename E, typename... RestE>
+	inline void format_select_expressions(std::string &output, unsigned int &index, const E &first,
+		const RestE &... rest)
+	{
+		output += "SELECT ";
+		format_expression(output, first, index);
+		format_expression_list(output, index, rest...);
+		output += " FROM ";
+		format_table_source(output, static_cast<T *>(nullptr));
+	}
+
+	template <typename T>
+	inline void format_count(std::string &output)
+	{
+		output += "SELECT COUNT(*) FROM ";
+		format_table_source(output, static_cast<T *>(nullptr));
+	}
+
+	template <typename T>
+	inline void format_max_rowid(std::string &output)
+	{
+		output += "SELECT MAX(rowid) FROM ";
+		output += default_table_name<T>();
+	}
+
+	template <typename T>
+	inline void format_insert(std::string &output, std::size_t rows)
+	{
+		output += "INSERT INTO ";
+		output += default_table_name<T>();
+		output += " (";
+		describe<T>(collect_regular_field_names([&] (const char *name, bool first) {
+			if (!first)
+				output += ',';
+			output += name;
+		}));
+		output += ") VALUES ";
+		for (auto row = rows; row; row--)
+		{
+			output += '(';
+			describe<T>(collect_regular_field_names([&] (const char *, bool first) {
+				if (!first)
+					output += ',';
+				output += '?';
+			}));
+			output += row > 1 ? ")," : ") ";
+		}
+	}
+
+	template <typename T>
+	inline void format_insert(std::string &output)
+	{	format_insert<T>(output, 1);	}
+
+	template <typename T>
+	inline void format_upsert(std::string &output, std::size_t rows)
+	{
+		format_insert<T>(output, rows);
+		output += " ON CONFLICT DO UPDATE SET ";
+		describe<T>(collect_regular_field_names([&] (const char *name, bool first) {
+			if (!first)
+				output += ',';
+			output += name;
+			output += "=EXCLUDED.";
+			output += name;
+		}));
+	}
+
+	template <typename T>
+	inline void format_upsert(std::string &output)
+	{	format_upsert<T>(output, 1);	}
+
+	template <typename T>
+	inline void format_update_by_identity(std::string &output)
+	{
+		output += "UPDATE ";
+		output += default_table_name<T>();
+		output += " SET ";
+		describe<T>(collect_regular_field_names([&] (const char *name, bool first) {
+			if (!first)
+				output += ',';
+			output += name;
+			output += "=?";
+		}));
+		describe<T>(collect_identity_field_names([&] (const char *name, bool first) {
+			output += first ? " WHERE " : " AND ";
+			output += name;
+			output += "=?";
+		}));
+	}
+
+	template <typename T>
+	inline void format_remove_by_identity(std::string &output)
+	{
+		output += "DELETE FROM ";
+		output += default_table_name<T>();
+		describe<T>(collect_identity_field_names([&] (const char *name, bool first) {
+			output += first ? " WHERE " : " AND ";
+			output += name;
+			output += "=?";
+		}));
+	}
+
+	template <typename T>
+	inline void format_returning(std::string &output)
+	{
+		output += " RETURNING ";
+		format_select_list(output, static_cast<T *>(nullptr));
+	}
+
+	template <typename T>
+	inline void format_returning_identity(std::string &output)
+	{
+		describe<T>(collect_identity_field_names([&] (const char *name, bool first) {
+			output += first ? " RETURNING " : ",";
+			output += name;
+		}));
+	}
+
+	template <void (*format_fn)(std::string &output)>
+	inline const std::string &static_text()
+	{
+		struct local
+		{
+			static std::string format()
+			{
+				std::string text;
+
+				format_fn(text);
+				return text;
+			}
+		};
+
+		static const std::string text = local::format();
+
+		return text;
+	}
 
 	template <typename T>
 	inline void format_create_table(std::string &output, const char *name)
@@ -461,6 +919,75 @@ namespace sql2xx
 		output += ")";
 	}
 
+	// Appends 'CREATE INDEX' statements for the indices declared with 'visitor << index << ...' to the output. Names are
+	// made of the table and column names; an index named as an earlier one gets its ordinal in describe() appended.
+	template <typename T>
+	inline void format_create_indices(std::vector<std::string> &output, const char *table_name)
+	{
+		std::list<index_definition> indices;
+		index_definition_visitor<T> v = {	indices	};
+		std::vector<std::string> names;
+		auto ordinal = 0;
+
+		describe<T>(v);
+		for (auto i = std::begin(indices); i != std::end(indices); ++i, ++ordinal)
+		{
+			std::string name = table_name, columns;
+
+			for (auto j = std::begin(i->columns); j != std::end(i->columns); ++j)
+			{
+				const auto space = j->find(' ');
+
+				if (!columns.empty())
+					columns += ",";
+				columns += *j;
+				name += '_';
+				name.append(*j, 0, space);
+				if (space != std::string::npos)
+					name += "_desc";
+			}
+			if (!i->where.empty())
+				name += "_partial";
+			if (std::find(names.begin(), names.end(), name) != names.end())
+				name += "_" + std::to_string(ordinal);
+			names.push_back(name);
+			output.push_back("CREATE INDEX " + name + "_idx ON " + table_name + "(" + columns + ")");
+			if (!i->where.empty())
+				output.back() += " WHERE " + i->where;
+		}
+	}
+
+	template <typename T>
+	template <typename U>
+	inline index_fields_collector<T> index_fields_collector<T>::operator <<(U T::*field) const
+	{
+		std::string name;
+
+		format_column(name, c(field));
+		definition.columns.emplace_back(name);
+		return *this;
+	}
+
+	template <typename T>
+	template <typename U>
+	inline index_fields_collector<T> index_fields_collector<T>::operator <<(descending<U T::*> field) const
+	{
+		std::string name;
+
+		format_column(name, c(field.field));
+		definition.columns.emplace_back(name + " DESC");
+		return *this;
+	}
+
+	template <typename T>
+	template <typename E>
+	inline index_fields_collector<T> index_fields_collector<T>::operator <<(const wrapped<E, bool> &where) const
+	{
+		definition.where.clear();
+		format_expression(definition.where, where);
+		return *this;
+	}
+
 	template <typename T>
 	template <typename U>
 	inline fields_collector<T> fields_collector<T>::operator <<(U T::*field) const
@@ -21,37 +21,182 @@
 #pragma once
 
 #include "binding.h"
+#include "format.h"
 #include "statement.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 namespace sql2xx
 {
 	template <typename T>
 	class inserter : statement
 	{
 	public:
-		inserter(sqlite3 &connection, statement_ptr &&statement);
+		typedef void (*format_fn_t)(std::string &output, std::size_t rows);
+
+	public:
+		inserter(const connection_ptr &connection, statement_ptr &&statement, format_fn_t format_batch,
+			bool upsert = false);
 
 		template <typename T2>
 		void operator ()(T2 &item);
 
+		template <typename IteratorT>
+		void operator ()(IteratorT begin_, IteratorT end_);
+
+		statement_stats stats() const; // Includes multi-row statements used for ranges.
+
+	private:
+		template <typename IteratorT>
+		void insert_batch(statement &batch, IteratorT begin_, IteratorT end_);
+
+		statement &get_batch(std::size_t rows);
+		bool rowids_ascend(std::size_t rows) const;
+
 	private:
-		sqlite3 &_connection;
+		connection_ptr _connection;
+		format_fn_t _format_batch;
+		std::unordered_map<std::size_t, statement> _batches;
+		std::vector<std::int64_t> _rowids;
+		std::size_t _max_batch_rows;
+		bool _upsert, _identity;
 	};
 
+	enum {	max_batch_rows = 64	};
+
 
 
 	template <typename T>
-	inline inserter<T>::inserter(sqlite3 &connection, statement_ptr &&statement_)
-		: statement(std::move(statement_)), _connection(connection)
-	{	}
+	inline inserter<T>::inserter(const connection_ptr &connection, statement_ptr &&statement_, format_fn_t format_batch,
+			bool upsert)
+		: statement(std::move(statement_)), _connection(connection), _format_batch(format_batch), _upsert(upsert),
+			_identity(false)
+	{
+		auto fields = 0;
+
+		describe<T>(collect_regular_field_names([&] (const char *, bool) {	fields++;	}));
+		describe<T>(collect_identity_field_names([&] (const char *, bool) {	_identity = true;	}));
+		_max_batch_rows = sqlite3_limit(_connection.get(), SQLITE_LIMIT_VARIABLE_NUMBER, -1) / (fields ? fields : 1);
+		if (_max_batch_rows > max_batch_rows)
+			_max_batch_rows = max_batch_rows;
+		else if (!_max_batch_rows) // Wider than the variable limit: insert row by row.
+			_max_batch_rows = 1;
+
+		// A row taking the conflict path keeps its old rowid, so the rowids returned by a multi-row upsert cannot be
+		// matched to the records by their order: upsert row by row, reading each identity back with RETURNING.
+		if (_upsert)
+			_max_batch_rows = 1;
+	}
 
 	template <typename T>
 	template <typename T2>
 	inline void inserter<T>::operator ()(T2 &item)
+	try
 	{
-		bind_fields<T>(*this, item);
+		if (_upsert) // The last inserted rowid is not updated when the conflict path is taken.
+			return insert_batch(get_batch(1), &item, &item + 1);
+		bind_fields<T>(*this, item, 1, static_binding);
 		execute();
-		bind_identity<T>(_connection, item);
+		bind_identity<T>(*_connection, item);
 		reset();
 	}
+	catch (...)
+	{
+		reset(); // Text fields are bound without copying: drop the references to the record.
+		throw;
+	}
+
+	template <typename T>
+	template <typename IteratorT>
+	inline void inserter<T>::operator ()(IteratorT begin_, IteratorT end_)
+	{
+		auto n = static_cast<std::size_t>(std::distance(begin_, end_));
+		const auto batch_rows = n > 1 && _max_batch_rows > 1 && _identity && !rowids_ascend(n) ? 1 : _max_batch_rows;
+
+		while (n)
+		{
+			const auto rows = n < batch_rows ? n : batch_rows;
+			auto end_batch = begin_;
+
+			std::advance(end_batch, rows);
+			if (rows > 1)
+				insert_batch(get_batch(rows), begin_, end_batch);
+			else
+				(*this)(*begin_);
+			begin_ = end_batch, n -= rows;
+		}
+	}
+
+	template <typename T>
+	template <typename IteratorT>
+	inline void inserter<T>::insert_batch(statement &batch, IteratorT begin_, IteratorT end_)
+	try
+	{
+		auto index = 1;
+
+		for (auto i = begin_; i != end_; ++i)
+			index = bind_fields<T>(batch, *i, index, static_binding);
+		_rowids.clear();
+		while (batch.execute())
+			_rowids.push_back(static_cast<std::int64_t>(batch.get(0)));
+		batch.reset();
+
+		// RETURNING rows come in no particular order, but a single VALUES list takes automatic rowids in increasing
+		// order of its rows: sorting the returned rowids restores the correspondence to the records. This assumes each
+		// new rowid is one past the largest in the table, which rowids_ascend() checks holds for the whole range; it
+		// does not hold for upserts either, which are never batched.
+		std::sort(_rowids.begin(), _rowids.end());
+
+		auto rowid = _rowids.begin();
+
+		for (auto i = begin_; i != end_ && rowid != _rowids.end(); ++i, ++rowid)
+			bind_identity<T>(*rowid, *i);
+	}
+	catch (...)
+	{
+		batch.reset();
+		throw;
+	}
+
+	template <typename T>
+	inline statement_stats inserter<T>::stats() const
+	{
+		auto r = statement::stats();
+
+		for (auto i = _batches.begin(); i != _batches.end(); ++i)
+			r += i->second.stats();
+		return r;
+	}
+
+	template <typename T>
+	inline bool inserter<T>::rowids_ascend(std::size_t rows) const
+	{
+		// Once the largest rowid is taken, SQLite picks unused rowids at random.
+		statement s(create_statement(_connection, static_text< format_max_rowid<T> >().c_str()));
+		const auto max_rowid = s.execute() && s.get(0).has_value() ? static_cast<std::int64_t>(s.get(0)) : 0;
+
+		return max_rowid <= std::numeric_limits<std::int64_t>::max() - static_cast<std::int64_t>(rows);
+	}
+
+	template <typename T>
+	inline statement &inserter<T>::get_batch(std::size_t rows)
+	{
+		const auto i = _batches.find(rows);
+
+		if (i != _batches.end())
+			return i->second;
+
+		std::string expression_text;
+
+		_format_batch(expression_text, rows);
+		format_returning_identity<T>(expression_text);
+		return _batches.insert(std::make_pair(rows, statement(create_statement(_connection, expression_text.c_str()))))
+			.first->second;
+	}
 }
@@ -20,37 +20,425 @@
 
 #pragma once
 
+#include "stats.h"
+
+#include <cstdint>
+#include <functional>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <sqlite3.h>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#if SQLITE_VERSION_NUMBER < 3037000
+	#error sql2++ requires SQLite 3.37.0 or later (RETURNING needs 3.35.0, sqlite3_changes64() needs 3.37.0).
+#endif
 
 namespace sql2xx
 {
+	class statement_cache;
 	struct sqlite3_deleter;
 	typedef std::shared_ptr<sqlite3> connection_ptr;
 	typedef std::unique_ptr<sqlite3_stmt, sqlite3_deleter> statement_ptr;
 
 
+	struct sql_error : std::runtime_error
+	{
+		sql_error(const std::string &text);
+
+		static void check_step(const connection_ptr &connection, int step_result);
+	};
+
 	struct sqlite3_deleter
 	{
-		void operator ()(sqlite3_stmt *ptr) const
-		{	sqlite3_finalize(ptr);	}
+		sqlite3_deleter();
+		sqlite3_deleter(const std::shared_ptr<statement_cache> &cache_);
+
+		void operator ()(sqlite3_stmt *ptr) const;
+
+		std::weak_ptr<statement_cache> cache;
+		std::shared_ptr<statement_registry> statistics;
+		std::shared_ptr<void> lease; // Statements keep the pool lease of their connection (if any), see connection_pool.
+	};
+
+	struct connection_deleter
+	{
+		void operator ()(sqlite3 *ptr);
+
+		std::shared_ptr<statement_cache> cache;
+		std::shared_ptr<statement_registry> statistics;
+		std::function<void (sqlite3 &database, const char *expression_text)> on_create_statement; // See guard_full_scans().
+		std::shared_ptr<void> lease; // Set for connections leased from a pool: the lease is returned instead of closing.
+	};
+
+	class statement_cache : public std::enable_shared_from_this<statement_cache>
+	{
+	public:
+		statement_cache(std::size_t capacity);
+		~statement_cache();
+
+		statement_ptr acquire(sqlite3 &database, const char *expression_text);
+		void release(sqlite3_stmt *statement_);
+
+		std::size_t capacity() const;
+		std::size_t size() const;
+		std::uint64_t hits() const;
+		std::uint64_t misses() const;
+
+	private:
+		struct entry
+		{
+			std::string expression_text;
+			sqlite3_stmt *statement_;
+			bool in_use;
+		};
+
+		typedef std::list<entry> entries_t;
+
+	private:
+		statement_cache(const statement_cache &other);
+		void operator =(const statement_cache &rhs);
+
+		void evict();
+
+	private:
+		mutable std::mutex _mutex; // Statements may be released on any thread.
+		entries_t _entries; // Most recently acquired go first.
+		std::unordered_map<std::string, entries_t::iterator> _index;
+		std::unordered_map<sqlite3_stmt *, entries_t::iterator> _owned;
+		std::string _key;
+		const std::size_t _capacity;
+		std::uint64_t _hits, _misses;
+	};
+
+	enum {	default_statement_cache_capacity = 64	};
+	enum {	default_busy_timeout_ms = 30000	};
+
+	// Settings applied to a connection when it's opened. Unset values leave SQLite defaults intact.
+	struct connection_options
+	{
+		enum journal_mode_type {	journal_default, journal_delete, journal_truncate, journal_persist, journal_memory,
+			journal_wal, journal_off,	};
+		enum synchronous_type {	synchronous_default, synchronous_off, synchronous_normal, synchronous_full,
+			synchronous_extra,	};
+		enum temp_store_type {	temp_store_default, temp_store_file, temp_store_memory,	};
+
+		connection_options();
+
+		static connection_options tuned();
+
+		journal_mode_type journal_mode;
+		synchronous_type synchronous;
+		temp_store_type temp_store;
+		std::int64_t mmap_size; // Negative - leave default.
+		int cache_size; // Zero - leave default. Negative values are in KiB, as in PRAGMA cache_size.
+		int page_size; // Zero - leave default. Only takes effect for a newly created database.
+		int busy_timeout_ms; // Zero - fail immediately on a locked database.
+		bool read_only;
+		bool no_mutex;
+		bool uri;
+		bool collect_statistics; // Aggregate statement statistics in a registry (see get_statement_statistics()).
+		std::size_t statement_cache_capacity;
 	};
 
 
-	inline connection_ptr create_connection(const char *path)
+
+	inline statement_ptr prepare_statement(sqlite3 &database, const char *expression_text, unsigned int flags)
+	{
+		sqlite3_stmt *p = nullptr;
+
+		sqlite3_prepare_v3(&database, expression_text, -1, flags, &p, nullptr);
+		return statement_ptr(p);
+	}
+
+	inline connection_ptr create_connection(const char *path,
+		std::size_t statement_cache_capacity = default_statement_cache_capacity)
 	{
 		sqlite3 *db = nullptr;
+		connection_deleter d;
 
 		sqlite3_open_v2(path, &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
-		return connection_ptr(db, [] (sqlite3 *ptr) {	sqlite3_close(ptr);	});
+		sqlite3_busy_timeout(db, default_busy_timeout_ms);
+		if (statement_cache_capacity)
+			d.cache = std::make_shared<statement_cache>(statement_cache_capacity);
+		return connection_ptr(db, d);
+	}
+
+	inline const char *journal_mode_name(connection_options::journal_mode_type mode)
+	{
+		const char *journal_modes[] = {	"", "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF",	};
+
+		return journal_modes[mode];
+	}
+
+	inline std::string get_journal_mode(sqlite3 &database)
+	{
+		statement_ptr s = prepare_statement(database, "PRAGMA journal_mode", 0);
+
+		return s && SQLITE_ROW == sqlite3_step(s.get())
+			? reinterpret_cast<const char *>(sqlite3_column_text(s.get(), 0)) : std::string();
+	}
+
+	inline void format_pragmas(std::string &output, const connection_options &options)
+	{
+		const char *synchronous_modes[] = {	"", "OFF", "NORMAL", "FULL", "EXTRA",	};
+		const char *temp_stores[] = {	"", "FILE", "MEMORY",	};
+
+		if (options.page_size)
+			output += "PRAGMA page_size=" + std::to_string(options.page_size) + ";";
+		if (options.journal_mode != connection_options::journal_default)
+			output += std::string("PRAGMA journal_mode=") + journal_mode_name(options.journal_mode) + ";";
+		if (options.synchronous != connection_options::synchronous_default)
+			output += std::string("PRAGMA synchronous=") + synchronous_modes[options.synchronous] + ";";
+		if (options.temp_store != connection_options::temp_store_default)
+			output += std::string("PRAGMA temp_store=") + temp_stores[options.temp_store] + ";";
+		if (options.mmap_size >= 0)
+			output += "PRAGMA mmap_size=" + std::to_string(options.mmap_size) + ";";
+		if (options.cache_size)
+			output += "PRAGMA cache_size=" + std::to_string(options.cache_size) + ";";
+	}
+
+	inline connection_ptr create_connection(const char *path, const connection_options &options)
+	{
+		sqlite3 *db = nullptr;
+		std::string pragmas;
+		const auto flags = (options.read_only ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE)
+			| (options.no_mutex ? SQLITE_OPEN_NOMUTEX : 0) | (options.uri ? SQLITE_OPEN_URI : 0);
+		auto result = sqlite3_open_v2(path, &db, flags, nullptr);
+
+		if (SQLITE_OK == result)
+			result = sqlite3_busy_timeout(db, options.busy_timeout_ms);
+		if (SQLITE_OK == result)
+			format_pragmas(pragmas, options), result = sqlite3_exec(db, pragmas.c_str(), nullptr, nullptr, nullptr);
+		if (SQLITE_OK != result)
+		{
+			const std::string text = std::string("SQLite error: ") + (db ? sqlite3_errmsg(db) : sqlite3_errstr(result)) + "!";
+
+			sqlite3_close(db);
+			throw sql_error(text);
+		}
+		if (options.journal_mode != connection_options::journal_default)
+		{
+			// SQLite reports a journal mode that cannot be set (e.g. WAL for an in-memory database) by keeping the old one.
+			const auto mode = get_journal_mode(*db);
+
+			if (sqlite3_stricmp(mode.c_str(), journal_mode_name(options.journal_mode)))
+			{
+				sqlite3_close(db);
+				throw sql_error(std::string("SQLite error: journal mode '") + journal_mode_name(options.journal_mode)
+					+ "' cannot be set, the database remains in '" + mode + "'!");
+			}
+		}
+
+		connection_deleter d;
+
+		if (options.statement_cache_capacity)
+			d.cache = std::make_shared<statement_cache>(options.statement_cache_capacity);
+		if (options.collect_statistics)
+			d.statistics = std::make_shared<statement_registry>();
+		return connection_ptr(db, d);
+	}
+
+	inline void execute(const connection_ptr &connection, const char *sql_statements)
+	{
+		if (SQLITE_OK != sqlite3_exec(connection.get(), sql_statements, nullptr, nullptr, nullptr))
+			sql_error::check_step(connection, 0);
+	}
+
+	inline statement_cache *get_statement_cache(const connection_ptr &connection)
+	{
+		const auto d = std::get_deleter<connection_deleter>(connection);
+
+		return d ? d->cache.get() : nullptr;
 	}
 
 	inline statement_ptr create_statement(sqlite3 &database,
 		const char *expression_text)
+	{	return prepare_statement(database, expression_text, 0);	}
+
+	inline statement_registry *get_statement_statistics(const connection_ptr &connection)
 	{
-		sqlite3_stmt *p = nullptr;
+		const auto d = std::get_deleter<connection_deleter>(connection);
 
-		sqlite3_prepare_v2(&database, expression_text, -1, &p, nullptr);
-		return statement_ptr(p);
+		return d ? d->statistics.get() : nullptr;
+	}
+
+	inline statement_ptr create_statement(const connection_ptr &connection, const char *expression_text)
+	{
+		const auto d = std::get_deleter<connection_deleter>(connection);
+
+		if (!d)
+			return create_statement(*connection, expression_text);
+		if (d->on_create_statement)
+			d->on_create_statement(*connection, expression_text);
+
+		auto s = d->cache ? d->cache->acquire(*connection, expression_text) : create_statement(*connection, expression_text);
+
+		if (d->statistics)
+			s.get_deleter().statistics = d->statistics;
+		if (d->lease)
+			s.get_deleter().lease = d->lease;
+		return s;
+	}
+
+
+	inline sql_error::sql_error(const std::string &text)
+		: std::runtime_error(text)
+	{	}
+
+	inline void sql_error::check_step(const connection_ptr &connection, int /*step_result*/)
+	{
+		std::string text = "SQLite error: ";
+			
+		text += sqlite3_errmsg(connection.get());
+		text += "!";
+		throw sql_error(text);
+	}
+
+
+	inline connection_options::connection_options()
+		: journal_mode(journal_default), synchronous(synchronous_default), temp_store(temp_store_default),
+			mmap_size(-1), cache_size(0), page_size(0), busy_timeout_ms(default_busy_timeout_ms), read_only(false), no_mutex(false),
+			uri(false), collect_statistics(false), statement_cache_capacity(default_statement_cache_capacity)
+	{	}
+
+	inline connection_options connection_options::tuned()
+	{
+		connection_options o;
+
+		o.journal_mode = journal_wal;
+		o.synchronous = synchronous_normal;
+		o.temp_store = temp_store_memory;
+		o.mmap_size = 256 * 1024 * 1024;
+		o.cache_size = -64 * 1024;
+		o.busy_timeout_ms = 5000;
+		return o;
+	}
+
+
+	inline sqlite3_deleter::sqlite3_deleter()
+	{	}
+
+	inline sqlite3_deleter::sqlite3_deleter(const std::shared_ptr<statement_cache> &cache_)
+		: cache(cache_)
+	{	}
+
+	inline void sqlite3_deleter::operator ()(sqlite3_stmt *ptr) const
+	{
+		if (const auto c = cache.lock())
+			c->release(ptr);
+		else
+			sqlite3_finalize(ptr);
+	}
+
+
+	inline void connection_deleter::operator ()(sqlite3 *ptr)
+	{
+		on_create_statement = nullptr;
+		statistics.reset();
+		cache.reset();
+		if (lease)
+			lease.reset();
+		else
+			sqlite3_close(ptr);
+	}
+
+
+	inline statement_cache::statement_cache(std::size_t capacity_)
+		: _capacity(capacity_), _hits(0), _misses(0)
+	{	}
+
+	inline statement_cache::~statement_cache()
+	{
+		for (auto i = _entries.begin(); i != _entries.end(); ++i)
+		{
+			if (!i->in_use)
+				sqlite3_finalize(i->statement_);
+		}
+	}
+
+	inline statement_ptr statement_cache::acquire(sqlite3 &database, const char *expression_text)
+	{
+		std::lock_guard<std::mutex> l(_mutex);
+
+		_key.assign(expression_text);
+
+		const auto i = _index.find(_key);
+
+		if (i != _index.end() && !i->second->in_use)
+		{
+			_hits++;
+			i->second->in_use = true;
+			_entries.splice(_entries.begin(), _entries, i->second);
+			return statement_ptr(i->second->statement_, sqlite3_deleter(shared_from_this()));
+		}
+
+		auto s = prepare_statement(database, expression_text, SQLITE_PREPARE_PERSISTENT);
+
+		_misses++;
+		if (!s || i != _index.end())
+			return s; // Failed to prepare or the cached one is in use: the caller owns this one exclusively.
+
+		entry e = {	_key, s.get(), true	};
+		const auto inserted = _entries.insert(_entries.begin(), e);
+
+		_index.insert(std::make_pair(_key, inserted));
+		_owned.insert(std::make_pair(s.get(), inserted));
+		evict();
+		return statement_ptr(s.release(), sqlite3_deleter(shared_from_this()));
+	}
+
+	inline void statement_cache::release(sqlite3_stmt *statement_)
+	{
+		std::lock_guard<std::mutex> l(_mutex);
+		const auto i = _owned.find(statement_);
+
+		if (i != _owned.end())
+		{
+			sqlite3_reset(statement_);
+			sqlite3_clear_bindings(statement_);
+			i->second->in_use = false;
+			evict();
+		}
+		else
+		{
+			sqlite3_finalize(statement_);
+		}
+	}
+
+	inline std::size_t statement_cache::capacity() const
+	{	return _capacity;	}
+
+	inline std::size_t statement_cache::size() const
+	{
+		std::lock_guard<std::mutex> l(_mutex);
+		return _entries.size();
+	}
+
+	inline std::uint64_t statement_cache::hits() const
+	{
+		std::lock_guard<std::mutex> l(_mutex);
+		return _hits;
+	}
+
+	inline std::uint64_t statement_cache::misses() const
+	{
+		std::lock_guard<std::mutex> l(_mutex);
+		return _misses;
+	}
+
+	inline void statement_cache::evict()
+	{
+		for (auto i = _entries.end(); _entries.size() > _capacity && i != _entries.begin(); )
+		{
+			if ((--i)->in_use)
+				continue;
+			sqlite3_finalize(i->statement_);
+			_index.erase(i->expression_text);
+			_owned.erase(i->statement_);
+			i = _entries.erase(i);
+		}
 	}
 }
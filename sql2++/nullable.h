@@ -89,7 +89,7 @@ namespace sql2xx
 
 	template <typename T>
 	inline nullable<T>::nullable()
-		: _has_value(false)
+		: _buffer(), _has_value(false)
 	{	}
 
 	template <typename T>
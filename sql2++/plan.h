@@ -0,0 +1,211 @@
+//	Copyright (c) 2011-2023 by Artem A. Gevorkyan (gevorkyan.org)
+//
+//	Permission is hereby granted, free of charge, to any person obtaining a copy
+//	of this software and associated documentation files (the "Software"), to deal
+//	in the Software without restriction, including without limitation the rights
+//	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//	copies of the Software, and to permit persons to whom the Software is
+//	furnished to do so, subject to the following conditions:
+//
+//	The above copyright notice and this permission notice shall be included in
+//	all copies or substantial portions of the Software.
+//
+//	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//	THE SOFTWARE.
+
+#pragma once
+
+#include "statement.h"
+
+#include <cctype>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace sql2xx
+{
+	struct query_plan_node
+	{
+		int id;
+		std::string detail; // E.g. 'SCAN books' or 'SEARCH t0 USING INTEGER PRIMARY KEY (rowid=?)'.
+		std::vector<query_plan_node> children;
+	};
+
+	typedef std::vector<query_plan_node> query_plan;
+
+	struct full_scan_error : sql_error
+	{
+		full_scan_error(const std::string &text);
+	};
+
+	typedef std::function<void (const char *expression_text, const char *table, std::size_t rows)> full_scan_handler;
+
+	class full_scan_guard
+	{
+	public:
+		full_scan_guard(std::size_t max_rows, const full_scan_handler &handler);
+
+		void operator ()(sqlite3 &database, const char *expression_text);
+
+	private:
+		std::size_t count_rows(sqlite3 &database, const std::string &table) const;
+
+	private:
+		const std::size_t _max_rows;
+		const full_scan_handler _handler;
+		std::unordered_set<std::string> _checked;
+	};
+
+
+
+	inline void add_query_plan_node(query_plan &plan, int parent, const query_plan_node &node)
+	{
+		if (!parent)
+			return plan.push_back(node);
+		for (auto i = plan.begin(); i != plan.end(); ++i)
+		{
+			if (i->id == parent)
+				return i->children.push_back(node);
+			add_query_plan_node(i->children, parent, node);
+		}
+	}
+
+	inline query_plan explain_query_plan(sqlite3 &database, const char *expression_text)
+	{
+		query_plan plan;
+		statement s(create_statement(database, (std::string("EXPLAIN QUERY PLAN ") + expression_text).c_str()));
+
+		while (s.execute())
+		{
+			query_plan_node node = {	s.get(0), static_cast<const char *>(s.get(3))	};
+
+			add_query_plan_node(plan, s.get(1), node);
+		}
+		return plan;
+	}
+
+	inline void format_query_plan(std::string &output, const query_plan &plan, unsigned int level = 0)
+	{
+		for (auto i = plan.begin(); i != plan.end(); ++i)
+		{
+			output.append(2 * level, ' ');
+			output += i->detail;
+			output += '\n';
+			format_query_plan(output, i->children, level + 1);
+		}
+	}
+
+	// Returns table names (or aliases) fully scanned according to the plan.
+	inline void collect_full_scans(std::vector<std::string> &tables, const query_plan &plan)
+	{
+		for (auto i = plan.begin(); i != plan.end(); ++i)
+		{
+			const auto &d = i->detail;
+
+			if (!d.compare(0, 5, "SCAN ") && d.compare(5, 8, "CONSTANT") && d[5] != '(')
+				tables.push_back(d.substr(5, d.find(' ', 5) - 5));
+			collect_full_scans(tables, i->children);
+		}
+	}
+
+	// Resolves 'name' if it's used as an alias in the query ('... FROM table AS name ...').
+	inline std::string resolve_table_alias(const std::string &expression_text, const std::string &name)
+	{
+		const auto is_identifier = [] (char c) {	return !!std::isalnum(static_cast<unsigned char>(c)) || c == '_';	};
+
+		for (auto p = expression_text.find(" AS " + name); p != std::string::npos;
+			p = expression_text.find(" AS " + name, p + 1))
+		{
+			const auto e = p + 4 + name.size();
+
+			if (e < expression_text.size() && is_identifier(expression_text[e]))
+				continue;
+
+			auto b = p;
+
+			while (b && is_identifier(expression_text[b - 1]))
+				b--;
+			if (b != p)
+				return expression_text.substr(b, p - b);
+		}
+		return name;
+	}
+
+	// Makes statements created on the connection be checked against their query plan: fully scanning a table having
+	// more than max_rows records is reported to the handler (or full_scan_error is thrown, if the handler is empty).
+	// Meant for tests and debugging. Returns false if the connection was not created by create_connection().
+	inline bool guard_full_scans(const connection_ptr &connection, std::size_t max_rows,
+		const full_scan_handler &handler = full_scan_handler())
+	{
+		const auto d = std::get_deleter<connection_deleter>(connection);
+
+		if (!d)
+			return false;
+
+		const auto guard = std::make_shared<full_scan_guard>(max_rows, handler);
+
+		d->on_create_statement = [guard] (sqlite3 &database, const char *expression_text) {
+			(*guard)(database, expression_text);
+		};
+		return true;
+	}
+
+
+	inline full_scan_error::full_scan_error(const std::string &text)
+		: sql_error(text)
+	{	}
+
+
+	inline full_scan_guard::full_scan_guard(std::size_t max_rows, const full_scan_handler &handler)
+		: _max_rows(max_rows), _handler(handler)
+	{	}
+
+	inline void full_scan_guard::operator ()(sqlite3 &database, const char *expression_text)
+	{
+		if (_checked.count(expression_text))
+			return;
+
+		const std::string text = expression_text;
+		std::vector<std::string> tables;
+		auto violated = false;
+
+		collect_full_scans(tables, explain_query_plan(database, expression_text));
+		for (auto i = tables.begin(); i != tables.end(); ++i)
+		{
+			const auto table = resolve_table_alias(text, *i);
+			const auto rows = count_rows(database, table);
+
+			if (rows <= _max_rows)
+				continue;
+			violated = true;
+			if (_handler)
+				_handler(expression_text, table.c_str(), rows);
+			else
+				throw full_scan_error("Full scan of '" + table + "' (more than " + std::to_string(_max_rows) + " rows): " + text);
+		}
+		if (!violated)
+			_checked.insert(text);
+	}
+
+	inline std::size_t full_scan_guard::count_rows(sqlite3 &database, const std::string &table) const
+	{
+		statement s(create_statement(database, ("SELECT count(*) FROM (SELECT 1 FROM " + table + " LIMIT "
+			+ std::to_string(_max_rows + 1) + ")").c_str()));
+
+		try
+		{
+			return s.execute() ? static_cast<std::size_t>(static_cast<std::uint64_t>(s.get(0))) : 0;
+		}
+		catch (const execution_error &)
+		{
+			return 0; // Not a table (e.g. a subquery).
+		}
+	}
+}
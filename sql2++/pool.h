@@ -0,0 +1,238 @@
+//	Copyright (c) 2011-2023 by Artem A. Gevorkyan (gevorkyan.org)
+//
+//	Permission is hereby granted, free of charge, to any person obtaining a copy
+//	of this software and associated documentation files (the "Software"), to deal
+//	in the Software without restriction, including without limitation the rights
+//	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//	copies of the Software, and to permit persons to whom the Software is
+//	furnished to do so, subject to the following conditions:
+//
+//	The above copyright notice and this permission notice shall be included in
+//	all copies or substantial portions of the Software.
+//
+//	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//	THE SOFTWARE.
+
+#pragma once
+
+#include "misc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace sql2xx
+{
+	struct pool_metrics
+	{
+		std::uint64_t reader_checkouts, writer_checkouts;
+		std::uint64_t reader_waits, writer_waits; // Checkouts that had to wait for a connection to be returned.
+		double reader_wait_seconds, writer_wait_seconds;
+		double reader_busy_seconds, writer_busy_seconds; // Total time connections were leased out for.
+		double uptime_seconds;
+		std::size_t readers, readers_in_use, peak_readers_in_use;
+	};
+
+	// A connection checked out from a pool. The connection returns to the pool once the lease, all its copies and
+	// everything created over its connection (transactions, readers, inserters, etc.) are destroyed.
+	class connection_lease
+	{
+	public:
+		connection_lease(const connection_ptr &connection, const std::shared_ptr<void> &token);
+
+		const connection_ptr &connection() const;
+		const std::shared_ptr<void> &token() const;
+
+	private:
+		connection_ptr _connection;
+		std::shared_ptr<void> _token;
+	};
+
+	// A pool for a database in WAL mode with a single writer connection and a number of read-only connections. Each
+	// connection is only used by a single lease holder at a time, so they are opened in multi-thread (NOMUTEX) mode.
+	class connection_pool
+	{
+	public:
+		connection_pool(const char *path, std::size_t readers,
+			const connection_options &options = connection_options::tuned());
+
+		connection_lease read();
+		connection_lease write();
+
+		pool_metrics metrics() const;
+
+	private:
+		typedef std::chrono::steady_clock clock;
+
+		struct state
+		{
+			mutable std::mutex mtx;
+			std::condition_variable readers_available, writer_available;
+			std::vector<connection_ptr> idle_readers;
+			connection_ptr writer;
+			bool writer_busy;
+			pool_metrics metrics;
+			clock::time_point created;
+		};
+
+		struct releaser
+		{
+			void operator ()(void *);
+
+			std::shared_ptr<state> state_;
+			connection_ptr connection;
+			bool writer;
+			clock::time_point acquired;
+		};
+
+	private:
+		static connection_lease lease(const releaser &r);
+		static double seconds(clock::duration d);
+
+	private:
+		std::shared_ptr<state> _state;
+	};
+
+
+
+	inline connection_lease::connection_lease(const connection_ptr &connection_, const std::shared_ptr<void> &token_)
+		: _connection(connection_), _token(token_)
+	{	}
+
+	inline const connection_ptr &connection_lease::connection() const
+	{	return _connection;	}
+
+	inline const std::shared_ptr<void> &connection_lease::token() const
+	{	return _token;	}
+
+
+	inline connection_pool::connection_pool(const char *path, std::size_t readers, const connection_options &options)
+		: _state(std::make_shared<state>())
+	{
+		if (!readers)
+			throw std::invalid_argument("A connection pool must have at least one reader");
+
+		auto writer_options = options;
+		auto reader_options = options;
+
+		writer_options.journal_mode = connection_options::journal_wal;
+		writer_options.read_only = false;
+		writer_options.no_mutex = true;
+		reader_options.journal_mode = connection_options::journal_default;
+		reader_options.page_size = 0;
+		reader_options.read_only = true;
+		reader_options.no_mutex = true;
+
+		_state->writer = create_connection(path, writer_options);
+		_state->writer_busy = false;
+		for (auto n = readers; n--; )
+			_state->idle_readers.push_back(create_connection(path, reader_options));
+
+		const pool_metrics m = {	0, 0, 0, 0, 0.0, 0.0, 0.0, 0.0, 0.0, readers, 0, 0	};
+
+		_state->metrics = m;
+		_state->created = clock::now();
+	}
+
+	inline connection_lease connection_pool::read()
+	{
+		auto &s = *_state;
+		std::unique_lock<std::mutex> l(s.mtx);
+		const auto start = clock::now();
+
+		if (s.idle_readers.empty())
+		{
+			s.metrics.reader_waits++;
+			s.readers_available.wait(l, [&s] {	return !s.idle_readers.empty();	});
+		}
+
+		const auto now = clock::now();
+		const releaser r = {	_state, s.idle_readers.back(), false, now	};
+
+		s.idle_readers.pop_back();
+		s.metrics.reader_checkouts++;
+		s.metrics.reader_wait_seconds += seconds(now - start);
+		s.metrics.peak_readers_in_use = (std::max)(s.metrics.peak_readers_in_use, ++s.metrics.readers_in_use);
+		l.unlock();
+		return lease(r);
+	}
+
+	inline connection_lease connection_pool::write()
+	{
+		auto &s = *_state;
+		std::unique_lock<std::mutex> l(s.mtx);
+		const auto start = clock::now();
+
+		if (s.writer_busy)
+		{
+			s.metrics.writer_waits++;
+			s.writer_available.wait(l, [&s] {	return !s.writer_busy;	});
+		}
+
+		const auto now = clock::now();
+		const releaser r = {	_state, s.writer, true, now	};
+
+		s.writer_busy = true;
+		s.metrics.writer_checkouts++;
+		s.metrics.writer_wait_seconds += seconds(now - start);
+		l.unlock();
+		return lease(r);
+	}
+
+	inline pool_metrics connection_pool::metrics() const
+	{
+		std::lock_guard<std::mutex> l(_state->mtx);
+		auto m = _state->metrics;
+
+		m.uptime_seconds = seconds(clock::now() - _state->created);
+		return m;
+	}
+
+	inline connection_lease connection_pool::lease(const releaser &r)
+	{
+		// The leased pointer shares the cache and statistics of the pooled one, but returns it instead of closing, so
+		// that anything keeping the connection keeps the lease.
+		auto d = *std::get_deleter<connection_deleter>(r.connection);
+
+		d.lease = std::shared_ptr<void>(r.connection.get(), r);
+
+		const connection_ptr leased(r.connection.get(), d);
+
+		return connection_lease(leased, leased);
+	}
+
+	inline double connection_pool::seconds(clock::duration d)
+	{	return std::chrono::duration<double>(d).count();	}
+
+
+	inline void connection_pool::releaser::operator ()(void *)
+	{
+		auto &s = *state_;
+		std::lock_guard<std::mutex> l(s.mtx);
+		const auto busy = seconds(clock::now() - acquired);
+
+		if (writer)
+		{
+			s.writer_busy = false;
+			s.metrics.writer_busy_seconds += busy;
+			s.writer_available.notify_one();
+		}
+		else
+		{
+			s.idle_readers.push_back(connection);
+			s.metrics.readers_in_use--;
+			s.metrics.reader_busy_seconds += busy;
+			s.readers_available.notify_one();
+		}
+	}
+}
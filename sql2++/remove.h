@@ -24,21 +24,20 @@
 #include "format.h"
 #include "statement.h"
 
-#include <functional>
-
 namespace sql2xx
 {
+	template <typename W>
 	class remover : statement
 	{
 	public:
-		template <typename W>
 		remover(statement_ptr &&statement, const W &where);
 
-		using statement::execute;
+		std::int64_t execute(); // Returns the number of records removed.
+		using statement::stats;
 		void reset();
 
 	private:
-		std::function<void ()> _reset_bindings;
+		const W _where;
 	};
 
 	class remove_builder
@@ -47,7 +46,10 @@ namespace sql2xx
 		remove_builder(const char *table_name);
 
 		template <typename W>
-		remover create_statement(sqlite3 &database, const W &where) const;
+		std::string expression_text(const W &where) const;
+
+		template <typename W>
+		remover<W> create_statement(const connection_ptr &connection, const W &where) const;
 
 	private:
 		std::string _expression_text;
@@ -56,14 +58,33 @@ namespace sql2xx
 
 
 	template <typename W>
-	inline remover::remover(statement_ptr &&statement_, const W &where)
-		: statement(std::move(statement_)), _reset_bindings([this, where] {	bind_parameters(*this, where);	})
-	{	_reset_bindings();	}
+	inline remover<W>::remover(statement_ptr &&statement_, const W &where)
+		: statement(std::move(statement_)), _where(where)
+	{
+		allow_in_chunks(_where);
+		bind_parameters(*this, _where);
+	}
+
+	template <typename W>
+	inline std::int64_t remover<W>::execute()
+	{
+		std::int64_t removed = 0;
+
+		for (;;)
+		{
+			statement::execute();
+			removed += changes();
+			if (!next_in_chunk(_where))
+				return removed;
+			reset();
+		}
+	}
 
-	inline void remover::reset()
+	template <typename W>
+	inline void remover<W>::reset()
 	{
 		statement::reset();
-		_reset_bindings();
+		bind_parameters(*this, _where);
 	}
 
 
@@ -72,12 +93,16 @@ namespace sql2xx
 	{	_expression_text += table_name;	}
 
 	template <typename W>
-	inline remover remove_builder::create_statement(sqlite3 &database, const W &where) const
+	inline std::string remove_builder::expression_text(const W &where) const
 	{
 		auto expression_text = _expression_text;
 
 		expression_text += " WHERE ";
 		format_expression(expression_text, where);
-		return remover(sql2xx::create_statement(database, expression_text.c_str()), where);
+		return expression_text;
 	}
+
+	template <typename W>
+	inline remover<W> remove_builder::create_statement(const connection_ptr &connection, const W &where) const
+	{	return remover<W>(sql2xx::create_statement(connection, expression_text(where).c_str()), where);	}
 }
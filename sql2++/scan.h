@@ -0,0 +1,136 @@
+//	Copyright (c) 2011-2023 by Artem A. Gevorkyan (gevorkyan.org)
+//
+//	Permission is hereby granted, free of charge, to any person obtaining a copy
+//	of this software and associated documentation files (the "Software"), to deal
+//	in the Software without restriction, including without limitation the rights
+//	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//	copies of the Software, and to permit persons to whom the Software is
+//	furnished to do so, subject to the following conditions:
+//
+//	The above copyright notice and this permission notice shall be included in
+//	all copies or substantial portions of the Software.
+//
+//	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//	THE SOFTWARE.
+
+#pragma once
+
+#include "database.h"
+
+#include <cstdint>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace sql2xx
+{
+	struct rowid_partition
+	{
+		std::int64_t first, last; // Both inclusive.
+	};
+
+	// Splits [first, last] rowid range into up to 'partitions' contiguous non-empty partitions of (nearly) equal size.
+	std::vector<rowid_partition> partition_rowids(std::int64_t first, std::int64_t last, std::size_t partitions);
+
+	// Reads the records of T matching 'where' in parallel: the table's rowid range is split into 'partitions' parts,
+	// each read on a separate thread over its own reader connection leased from the pool. The callback is invoked as
+	// callback(partition_index, record) concurrently from these threads (but sequentially within a partition). Each
+	// partition reads its own snapshot of the database. The first exception thrown by a worker is rethrown once all
+	// of them are done.
+	template <typename T, typename W, typename F>
+	void parallel_scan(connection_pool &pool, std::size_t partitions, const wrapped<W, bool> &where, const F &callback);
+
+	template <typename T, typename F>
+	void parallel_scan(connection_pool &pool, std::size_t partitions, const F &callback);
+
+
+
+	inline std::vector<rowid_partition> partition_rowids(std::int64_t first, std::int64_t last,
+		std::size_t partitions)
+	{
+		std::vector<rowid_partition> result;
+
+		if (first > last || !partitions)
+			return result;
+
+		const auto span = static_cast<std::uint64_t>(last) - static_cast<std::uint64_t>(first) + 1;
+		const auto n = span < partitions ? span : static_cast<std::uint64_t>(partitions);
+		const auto size = span / n, remainder = span % n;
+		auto start = static_cast<std::uint64_t>(first);
+
+		for (std::uint64_t k = 0; k != n; ++k)
+		{
+			const auto length = size + (k < remainder ? 1 : 0);
+			const rowid_partition p = {	static_cast<std::int64_t>(start), static_cast<std::int64_t>(start + length - 1)	};
+
+			result.push_back(p);
+			start += length;
+		}
+		return result;
+	}
+
+	template <typename T, typename W, typename F>
+	inline void parallel_scan(connection_pool &pool, std::size_t partitions, const wrapped<W, bool> &where,
+		const F &callback)
+	{
+		std::vector<rowid_partition> parts;
+
+		{
+			const auto lease = pool.read();
+			transaction t(lease);
+			statement s(create_statement(lease.connection(),
+				("SELECT MIN(rowid),MAX(rowid) FROM " + default_table_name<T>()).c_str()));
+
+			if (s.execute() && s.get(0).has_value())
+				parts = partition_rowids(s.get(0), s.get(1), partitions);
+		}
+
+		std::vector<std::thread> workers;
+		std::vector<std::exception_ptr> errors(parts.size());
+		const auto join_all = [&workers] {
+			for (auto i = workers.begin(); i != workers.end(); ++i)
+				i->join();
+		};
+
+		workers.reserve(parts.size());
+		for (auto k = 0u; k != parts.size(); ++k)
+		try
+		{
+			workers.push_back(std::thread([&, k] {
+				try
+				{
+					const auto &part = parts[k];
+					transaction t(pool.read());
+					auto r = t.select<T>(where && rowid() >= p(part.first) && rowid() <= p(part.last));
+
+					for (T record; r(record); )
+						callback(static_cast<std::size_t>(k), static_cast<const T &>(record));
+				}
+				catch (...)
+				{
+					errors[k] = std::current_exception();
+				}
+			}));
+		}
+		catch (...)
+		{
+			join_all(); // Workers refer to this frame: let the started ones finish before unwinding.
+			throw;
+		}
+		join_all();
+		for (auto i = errors.begin(); i != errors.end(); ++i)
+		{
+			if (*i)
+				std::rethrow_exception(*i);
+		}
+	}
+
+	template <typename T, typename F>
+	inline void parallel_scan(connection_pool &pool, std::size_t partitions, const F &callback)
+	{	parallel_scan<T>(pool, partitions, lit(true), callback);	}
+}
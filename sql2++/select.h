@@ -26,10 +26,56 @@
 #include "types.h"
 
 #include <cstdint>
+#include <functional>
+#include <iterator>
 #include <tuple>
+#include <vector>
 
 namespace sql2xx
 {
+	template <typename F>
+	inline void read_value(F &value, const statement::field_accessor &accessor)
+	{	value = accessor;	}
+
+	template <typename F>
+	inline void read_value(nullable<F> &value, const statement::field_accessor &accessor)
+	{	value = !accessor.has_value() ? nullable<F>() : nullable<F>(accessor);	}
+
+	inline void read_value(std::string &value, const statement::field_accessor &accessor)
+	{
+		const text_view text = accessor;
+
+		value.assign(text.data(), text.size());
+	}
+
+	inline void read_value(nullable<std::string> &value, const statement::field_accessor &accessor)
+	{
+		if (!accessor.has_value())
+			value = nullable<std::string>();
+		else if (value.has_value())
+			read_value(*value, accessor);
+		else
+			value = std::string(), read_value(*value, accessor);
+	}
+
+	inline void read_value(std::vector<std::uint8_t> &value, const statement::field_accessor &accessor)
+	{
+		const blob_view data = accessor;
+
+		value.assign(data.begin(), data.end());
+	}
+
+	inline void read_value(nullable< std::vector<std::uint8_t> > &value, const statement::field_accessor &accessor)
+	{
+		if (!accessor.has_value())
+			value = nullable< std::vector<std::uint8_t> >();
+		else if (value.has_value())
+			read_value(*value, accessor);
+		else
+			value = std::vector<std::uint8_t>(), read_value(*value, accessor);
+	}
+
+
 	template <typename T>
 	struct record_reader
 	{
@@ -39,28 +85,7 @@ namespace sql2xx
 
 		template <typename FieldT, typename U>
 		void operator ()(FieldT U::*field, const char *)
-		{	record.*field = statement_.get(index++);	}
-
-		template <typename FieldT, typename U>
-		void operator ()(nullable<FieldT> U::*field, const char *)
-		{
-			auto accessor = statement_.get(index++);
-
-			record.*field = !accessor.has_value() ? nullable<FieldT>() : nullable<FieldT>(accessor);
-		}
-
-		template <typename U>
-		void operator ()(std::string U::*field, const char *)
-		{	record.*field = static_cast<const char *>(statement_.get(index++));	}
-
-		template <typename U>
-		void operator ()(nullable<std::string> U::*field, const char *)
-		{
-			auto accessor = statement_.get(index++);
-
-			record.*field = !accessor.has_value()
-				? nullable<std::string>() : nullable<std::string>(std::string(static_cast<const char*>(accessor)));
-		}
+		{	read_value(record.*field, statement_.get(index++));	}
 
 		template <typename TagT, typename F>
 		void operator ()(TagT, F field, const char *name)
@@ -75,15 +100,77 @@ namespace sql2xx
 		int index;
 	};
 
+	template <std::size_t i, std::size_t n>
+	struct tuple_value_reader
+	{
+		template <typename TupleT>
+		static void read(TupleT &values, statement &statement_)
+		{
+			read_value(std::get<i>(values), statement_.get(static_cast<int>(i)));
+			tuple_value_reader<i + 1, n>::read(values, statement_);
+		}
+	};
+
+	template <std::size_t n>
+	struct tuple_value_reader<n, n>
+	{
+		template <typename TupleT>
+		static void read(TupleT &/*values*/, statement &/*statement_*/)
+		{	}
+	};
+
 	template <typename T>
 	class reader : statement
 	{
 	public:
-		template <typename W>
-		reader(statement_ptr &&statement, const W &where);
+		class iterator;
+
+	public:
+		template <typename W, typename... OrderT>
+		reader(statement_ptr &&statement, const W &where, const OrderT &... order);
 		reader(statement_ptr &&statement);
 
 		bool operator ()(T& value);
+
+		// Reads up to n records into 'records', reading into the elements already there first. On return 'records'
+		// contains just the records read: fewer than n means the end is reached.
+		std::size_t read_chunk(std::vector<T> &records, std::size_t n);
+
+		iterator begin();
+		iterator end();
+
+		using statement::stats;
+
+	private:
+		std::function<bool (statement &statement_)> _next_chunk; // Only set for IN lists bound in chunks.
+	};
+
+	// A single-pass iterator over the records of a reader. The record referenced is valid until the next increment.
+	template <typename T>
+	class reader<T>::iterator
+	{
+	public:
+		typedef std::input_iterator_tag iterator_category;
+		typedef T value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef const T *pointer;
+		typedef const T &reference;
+
+	public:
+		iterator();
+		explicit iterator(reader &reader_);
+
+		const T &operator *() const;
+		const T *operator ->() const;
+		iterator &operator ++();
+		iterator operator ++(int);
+
+		bool operator ==(const iterator &rhs) const;
+		bool operator !=(const iterator &rhs) const;
+
+	private:
+		reader *_reader;
+		T _record;
 	};
 
 	template <typename T>
@@ -92,14 +179,57 @@ namespace sql2xx
 	public:
 		select_builder();
 
-		reader<T> create_reader(sqlite3 &database) const;
+		const std::string &expression_text() const;
+
+		template <typename T2, typename R, typename... OrderT>
+		std::string expression_text(const wrapped<T2, R> &where, OrderT&&... order) const;
+
+		reader<T> create_reader(const connection_ptr &connection) const;
+
+		template <typename T2, typename R, typename... OrderT>
+		reader<T> create_reader(const connection_ptr &connection, const wrapped<T2, R> &where, OrderT&&... order) const;
+
+	private:
+		const std::string &_expression_text;
+	};
+
+	template <typename... F>
+	class projection_reader : statement
+	{
+	public:
+		typedef std::function<void (statement &statement_, unsigned int &index)> bind_fn_t;
+
+	public:
+		template <typename W, typename... OrderT>
+		projection_reader(statement_ptr &&statement, const bind_fn_t &bind_expressions, const W &where,
+			const OrderT &... order);
+		projection_reader(statement_ptr &&statement);
+
+		bool operator ()(std::tuple<F...> &values);
+
+		using statement::stats;
+	};
+
+	template <typename... F>
+	class projection_builder
+	{
+	public:
+		template <typename T, typename... E>
+		projection_builder(const connection_ptr &connection, T *table, const E &... expressions);
+
+		const std::string &expression_text() const;
+
+		template <typename... OrderT>
+		projection_reader<F...> all(OrderT&&... order) const;
 
 		template <typename T2, typename R, typename... OrderT>
-		reader<T> create_reader(sqlite3 &database, const wrapped<T2, R> &where, OrderT&&... order) const;
+		projection_reader<F...> where(const wrapped<T2, R> &where, OrderT&&... order) const;
 
 	private:
-		int _index;
+		connection_ptr _connection;
 		std::string _expression_text;
+		unsigned int _first_index; // Parameters of the select list come first: the rest are numbered from here on.
+		typename projection_reader<F...>::bind_fn_t _bind_expressions; // Only set if the select list has parameters.
 	};
 
 
@@ -112,32 +242,55 @@ namespace sql2xx
 		describe<T>(rr);
 	}
 
-	template <typename T1, typename T2>
-	inline void read_field(std::tuple<T1, T2> &record, statement &statement_)
+	template <std::size_t i, std::size_t n>
+	struct joined_record_reader
 	{
-		record_reader<T1> rr0 = {	std::get<0>(record), statement_, 0	};
-		describe<T1>(rr0);
-		record_reader<T2> rr1 = {	std::get<1>(record), statement_, rr0.index	};
-		describe<T2>(rr1);
-	}
+		template <typename TupleT>
+		static void read(TupleT &record, statement &statement_, int index)
+		{
+			typedef typename std::tuple_element<i, TupleT>::type table_type;
+			record_reader<table_type> rr = {	std::get<i>(record), statement_, index	};
 
-	template <typename T1, typename T2, typename T3>
-	inline void read_field(std::tuple<T1, T2, T3> &record, statement &statement_)
+			describe<table_type>(rr);
+			joined_record_reader<i + 1, n>::read(record, statement_, rr.index);
+		}
+	};
+
+	template <std::size_t n>
+	struct joined_record_reader<n, n>
 	{
-		record_reader<T1> rr0 = {	std::get<0>(record), statement_, 0	};
-		describe<T1>(rr0);
-		record_reader<T2> rr1 = {	std::get<1>(record), statement_, rr0.index	};
-		describe<T2>(rr1);
-		record_reader<T3> rr2 = {	std::get<2>(record), statement_, rr1.index	};
-		describe<T3>(rr2);
-	}
+		template <typename TupleT>
+		static void read(TupleT &/*record*/, statement &/*statement_*/, int /*index*/)
+		{	}
+	};
+
+	template <typename... T>
+	inline void read_field(std::tuple<T...> &record, statement &statement_)
+	{	joined_record_reader<0, sizeof...(T)>::read(record, statement_, 0);	}
 
 
 	template <typename T>
-	template <typename W>
-	inline reader<T>::reader(statement_ptr &&statement_, const W &where)
+	template <typename W, typename... OrderT>
+	inline reader<T>::reader(statement_ptr &&statement_, const W &where, const OrderT &... order)
 		: statement(std::move(statement_))
-	{	bind_parameters(*this, where);	}
+	{
+		const W w(where); // IN lists bound in chunks keep their state in the copy.
+
+		allow_in_chunks(w);
+		bind_parameters(*this, w);
+		bind_modifiers(*this, order...);
+		if (in_chunked(w))
+		{
+			if (sizeof...(OrderT))
+				throw sql_error("Records selected by an IN list bound in chunks cannot be ordered or limited");
+			_next_chunk = [w] (statement &statement_) -> bool {
+				if (!next_in_chunk(w))
+					return false;
+				bind_parameters(statement_, w);
+				return true;
+			};
+		}
+	}
 
 	template <typename T>
 	inline reader<T>::reader(statement_ptr &&statement_)
@@ -146,31 +299,195 @@ namespace sql2xx
 
 	template <typename T>
 	inline bool reader<T>::operator ()(T& record)
-	{	return execute() ? read_field(record, *this), true : false;	}
+	{
+		while (!execute())
+		{
+			if (!_next_chunk)
+				return false;
+			reset(); // After the last chunk parameters are left unbound (NULL), matching nothing on re-execution.
+			if (!_next_chunk(*this))
+				return false;
+		}
+		read_field(record, *this);
+		return true;
+	}
 
 
 	template <typename T>
-	inline select_builder<T>::select_builder()
-		: _expression_text("SELECT ")
+	inline std::size_t reader<T>::read_chunk(std::vector<T> &records, std::size_t n)
+	{
+		std::size_t read = 0;
+
+		for (; read != n && read != records.size(); ++read)
+		{
+			if (!(*this)(records[read]))
+				break;
+		}
+		for (T record; read == records.size() && read != n && (*this)(record); ++read)
+			records.push_back(std::move(record));
+		records.resize(read);
+		return read;
+	}
+
+	template <typename T>
+	inline typename reader<T>::iterator reader<T>::begin()
+	{	return iterator(*this);	}
+
+	template <typename T>
+	inline typename reader<T>::iterator reader<T>::end()
+	{	return iterator();	}
+
+
+	template <typename T>
+	inline reader<T>::iterator::iterator()
+		: _reader(nullptr)
+	{	}
+
+	template <typename T>
+	inline reader<T>::iterator::iterator(reader &reader_)
+		: _reader(&reader_)
+	{	++*this;	}
+
+	template <typename T>
+	inline const T &reader<T>::iterator::operator *() const
+	{	return _record;	}
+
+	template <typename T>
+	inline const T *reader<T>::iterator::operator ->() const
+	{	return &_record;	}
+
+	template <typename T>
+	inline typename reader<T>::iterator &reader<T>::iterator::operator ++()
+	{
+		if (!(*_reader)(_record))
+			_reader = nullptr;
+		return *this;
+	}
+
+	template <typename T>
+	inline typename reader<T>::iterator reader<T>::iterator::operator ++(int)
 	{
-		format_select_list(_expression_text, static_cast<T *>(nullptr));
-		_expression_text += " FROM ";
-		format_table_source(_expression_text, static_cast<T *>(nullptr));
+		auto previous = *this;
+
+		++*this;
+		return previous;
 	}
 
 	template <typename T>
-	inline reader<T> select_builder<T>::create_reader(sqlite3 &database) const
-	{	return reader<T>(create_statement(database, _expression_text.c_str()));	}
+	inline bool reader<T>::iterator::operator ==(const iterator &rhs) const
+	{	return _reader == rhs._reader;	}
+
+	template <typename T>
+	inline bool reader<T>::iterator::operator !=(const iterator &rhs) const
+	{	return !(*this == rhs);	}
+
+
+	template <typename T>
+	inline select_builder<T>::select_builder()
+		: _expression_text(static_text< format_select<T> >())
+	{	}
+
+	template <typename T>
+	inline const std::string &select_builder<T>::expression_text() const
+	{	return _expression_text;	}
 
 	template <typename T>
 	template <typename T2, typename R, typename... OrderT>
-	inline reader<T> select_builder<T>::create_reader(sqlite3 &database, const wrapped<T2, R> &where, OrderT&&... order) const
+	inline std::string select_builder<T>::expression_text(const wrapped<T2, R> &where, OrderT&&... order) const
 	{
 		auto expression_text = _expression_text;
 
 		expression_text += " WHERE ";
 		format_expression(expression_text, where);
 		format_order(expression_text, std::forward<OrderT>(order)...);
-		return reader<T>(create_statement(database, expression_text.c_str()), where);
+		return expression_text;
+	}
+
+	template <typename T>
+	inline reader<T> select_builder<T>::create_reader(const connection_ptr &connection) const
+	{	return reader<T>(create_statement(connection, _expression_text.c_str()));	}
+
+	template <typename T>
+	template <typename T2, typename R, typename... OrderT>
+	inline reader<T> select_builder<T>::create_reader(const connection_ptr &connection, const wrapped<T2, R> &where, OrderT&&... order) const
+	{
+		return reader<T>(create_statement(connection, expression_text(where, order...).c_str()), where, order...);
+	}
+
+
+	template <typename... F>
+	template <typename W, typename... OrderT>
+	inline projection_reader<F...>::projection_reader(statement_ptr &&statement_, const bind_fn_t &bind_expressions,
+			const W &where, const OrderT &... order)
+		: statement(std::move(statement_))
+	{
+		const W w(where);
+		auto index = 1u;
+
+		if (bind_expressions)
+			bind_expressions(*this, index);
+		allow_in_chunks(w);
+		bind_parameters(*this, w, index);
+		bind_grouping(*this, index, order...);
+		bind_modifiers(*this, order...);
+		if (in_chunked(w))
+			throw sql_error("Projections cannot be selected by an IN list bound in chunks");
+	}
+
+	template <typename... F>
+	inline projection_reader<F...>::projection_reader(statement_ptr &&statement_)
+		: statement(std::move(statement_))
+	{	}
+
+	template <typename... F>
+	inline bool projection_reader<F...>::operator ()(std::tuple<F...> &values)
+	{	return execute() ? tuple_value_reader<0, sizeof...(F)>::read(values, *this), true : false;	}
+
+
+	template <typename... F>
+	template <typename T, typename... E>
+	inline projection_builder<F...>::projection_builder(const connection_ptr &connection, T * /*table*/,
+			const E &... expressions)
+		: _connection(connection), _first_index(1u)
+	{
+		format_select_expressions<T>(_expression_text, _first_index, expressions...);
+		if (_first_index > 1u)
+		{
+			const auto bound_expressions = std::make_tuple(expressions...);
+
+			_bind_expressions = [bound_expressions] (statement &statement_, unsigned int &index) {
+				row_value_binder<0, sizeof...(E)>::bind(statement_, bound_expressions, index);
+			};
+		}
+	}
+
+	template <typename... F>
+	inline const std::string &projection_builder<F...>::expression_text() const
+	{	return _expression_text;	}
+
+	template <typename... F>
+	template <typename... OrderT>
+	inline projection_reader<F...> projection_builder<F...>::all(OrderT&&... order) const
+	{
+		auto expression_text = _expression_text;
+		auto index = _first_index;
+
+		format_grouping(expression_text, index, order...);
+		return projection_reader<F...>(create_statement(_connection, expression_text.c_str()), _bind_expressions,
+			lit(true) /*nothing to bind*/, order...);
+	}
+
+	template <typename... F>
+	template <typename T2, typename R, typename... OrderT>
+	inline projection_reader<F...> projection_builder<F...>::where(const wrapped<T2, R> &where, OrderT&&... order) const
+	{
+		auto expression_text = _expression_text;
+		auto index = _first_index;
+
+		expression_text += " WHERE ";
+		format_expression(expression_text, where, index);
+		format_grouping(expression_text, index, order...);
+		return projection_reader<F...>(create_statement(_connection, expression_text.c_str()), _bind_expressions,
+			where, order...);
 	}
 }
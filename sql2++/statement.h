@@ -22,14 +22,19 @@
 
 #include "misc.h"
 #include "nullable.h"
+#include "view.h"
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace sql2xx
 {
+	enum binding_lifetime {	transient_binding, static_binding	};
+
 	struct execution_error : std::runtime_error
 	{
 		execution_error(int code_);
@@ -44,9 +49,14 @@ namespace sql2xx
 
 	public:
 		statement(statement_ptr &&underlying);
+		statement(statement &&other);
+		~statement();
 
 		void reset();
 		bool execute();
+		std::int64_t changes() const; // Rows changed by the last INSERT, UPDATE or DELETE completed on the connection.
+
+		statement_stats stats() const;
 
 		template <typename T>
 		void bind(int index, const nullable<T> &value);
@@ -57,10 +67,32 @@ namespace sql2xx
 		void bind(int index, double value);
 		void bind(int index, const char *value);
 		void bind(int index, const std::string &value);
+		void bind(int index, const text_view &value);
+		void bind(int index, const std::vector<std::uint8_t> &value);
+		void bind(int index, const blob_view &value);
+
+		template <typename T>
+		void bind(int index, const T &value, binding_lifetime lifetime);
+		template <typename T>
+		void bind(int index, const nullable<T> &value, binding_lifetime lifetime);
+		void bind(int index, const std::string &value, binding_lifetime lifetime);
+		void bind(int index, const text_view &value, binding_lifetime lifetime);
+		void bind(int index, const std::vector<std::uint8_t> &value, binding_lifetime lifetime);
+		void bind(int index, const blob_view &value, binding_lifetime lifetime);
+		void bind_zeroblob(int index, std::size_t size);
+		int parameter_index(const char *name) const;
+
 		field_accessor get(int index) const;
 
+	private:
+		statement(const statement &other);
+		void operator =(const statement &rhs);
+
 	private:
 		statement_ptr _underlying;
+		std::uint64_t _rows, _changes;
+		std::int64_t _total_changes; // The connection's total when the current run started.
+		std::chrono::steady_clock::duration _execute_time;
 	};
 
 	class statement::field_accessor
@@ -74,6 +106,8 @@ namespace sql2xx
 		operator std::uint64_t() const;
 		operator double() const;
 		operator const char *() const;
+		operator text_view() const;
+		operator blob_view() const;
 
 		bool has_value() const;
 
@@ -85,9 +119,29 @@ namespace sql2xx
 
 
 	inline statement::statement(statement_ptr &&underlying)
-		: _underlying(std::move(underlying))
+		: _underlying(std::move(underlying)), _rows(0), _changes(0), _total_changes(0), _execute_time(0)
+	{
+		const int counters[] = {	SQLITE_STMTSTATUS_FULLSCAN_STEP, SQLITE_STMTSTATUS_SORT, SQLITE_STMTSTATUS_AUTOINDEX,
+			SQLITE_STMTSTATUS_VM_STEP, SQLITE_STMTSTATUS_REPREPARE, SQLITE_STMTSTATUS_RUN,	};
+
+		if (_underlying) // A statement may come from the cache: only count what happens from now on.
+		{
+			for (auto i = 0u; i != sizeof(counters) / sizeof(counters[0]); ++i)
+				sqlite3_stmt_status(_underlying.get(), counters[i], 1);
+		}
+	}
+
+	inline statement::statement(statement &&other)
+		: _underlying(std::move(other._underlying)), _rows(other._rows), _changes(other._changes),
+			_total_changes(other._total_changes), _execute_time(other._execute_time)
 	{	}
 
+	inline statement::~statement()
+	{
+		if (_underlying && _underlying.get_deleter().statistics)
+			_underlying.get_deleter().statistics->record(sqlite3_sql(_underlying.get()), stats());
+	}
+
 	inline void statement::reset()
 	{
 		sqlite3_reset(_underlying.get());
@@ -96,14 +150,59 @@ namespace sql2xx
 
 	inline bool statement::execute()
 	{
-		switch (auto result = sqlite3_step(_underlying.get()))
+		// sqlite3_changes() is not reset by DDL, PRAGMA or transaction control statements, so it is only credited to a
+		// run that moved the connection's total. Unlike the total, it excludes trigger and foreign key cascade changes,
+		// matching changes(). It is set once the statement is done, even with RETURNING.
+		const auto s = _underlying.get();
+		const auto readonly = !!sqlite3_stmt_readonly(s);
+		const auto timed = !!_underlying.get_deleter().statistics;
+		const auto start = timed ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+
+		if (!readonly && !sqlite3_stmt_busy(s))
+			_total_changes = sqlite3_total_changes64(sqlite3_db_handle(s));
+
+		const auto result = sqlite3_step(s);
+
+		if (timed)
+			_execute_time += std::chrono::steady_clock::now() - start;
+		if (!readonly && result == SQLITE_DONE
+				&& sqlite3_total_changes64(sqlite3_db_handle(s)) != _total_changes)
+			_changes += static_cast<std::uint64_t>(sqlite3_changes64(sqlite3_db_handle(s)));
+		switch (result)
 		{
-		case SQLITE_DONE: return false;
-		case SQLITE_ROW: return true;
-		default: throw execution_error(result);
+		case SQLITE_DONE:
+			return false;
+
+		case SQLITE_ROW:
+			_rows++;
+			return true;
+
+		default:
+			throw execution_error(result);
 		}
 	}
 
+	inline std::int64_t statement::changes() const
+	{	return sqlite3_changes64(sqlite3_db_handle(_underlying.get()));	}
+
+	inline statement_stats statement::stats() const
+	{
+		const auto s = _underlying.get();
+		statement_stats r;
+
+		r.fullscan_steps = static_cast<std::uint64_t>(sqlite3_stmt_status(s, SQLITE_STMTSTATUS_FULLSCAN_STEP, 0));
+		r.sorts = static_cast<std::uint64_t>(sqlite3_stmt_status(s, SQLITE_STMTSTATUS_SORT, 0));
+		r.autoindexes = static_cast<std::uint64_t>(sqlite3_stmt_status(s, SQLITE_STMTSTATUS_AUTOINDEX, 0));
+		r.vm_steps = static_cast<std::uint64_t>(sqlite3_stmt_status(s, SQLITE_STMTSTATUS_VM_STEP, 0));
+		r.reprepares = static_cast<std::uint64_t>(sqlite3_stmt_status(s, SQLITE_STMTSTATUS_REPREPARE, 0));
+		r.runs = static_cast<std::uint64_t>(sqlite3_stmt_status(s, SQLITE_STMTSTATUS_RUN, 0));
+		r.memory_used = static_cast<std::uint64_t>(sqlite3_stmt_status(s, SQLITE_STMTSTATUS_MEMUSED, 0));
+		r.rows = _rows;
+		r.changes = _changes;
+		r.execute_seconds = std::chrono::duration<double>(_execute_time).count();
+		return r;
+	}
+
 	template <typename T>
 	inline void statement::bind(int index, const nullable<T> &value)
 	{
@@ -130,7 +229,54 @@ namespace sql2xx
 	{	sqlite3_bind_text(_underlying.get(), index, value, -1, SQLITE_TRANSIENT);	}
 
 	inline void statement::bind(int index, const std::string &value)
-	{	bind(index, value.c_str()); }
+	{	bind(index, value, transient_binding);	}
+
+	template <typename T>
+	inline void statement::bind(int index, const T &value, binding_lifetime /*lifetime*/)
+	{	bind(index, value);	}
+
+	template <typename T>
+	inline void statement::bind(int index, const nullable<T> &value, binding_lifetime lifetime)
+	{
+		if (value.has_value())
+			bind(index, *value, lifetime);
+	}
+
+	inline void statement::bind(int index, const std::string &value, binding_lifetime lifetime)
+	{	bind(index, text_view(value), lifetime);	}
+
+	inline void statement::bind(int index, const text_view &value)
+	{	bind(index, value, transient_binding);	}
+
+	inline void statement::bind(int index, const text_view &value, binding_lifetime lifetime)
+	{
+		sqlite3_bind_text(_underlying.get(), index, value.data(), static_cast<int>(value.size()),
+			lifetime == static_binding ? SQLITE_STATIC : SQLITE_TRANSIENT);
+	}
+
+	inline void statement::bind(int index, const std::vector<std::uint8_t> &value)
+	{	bind(index, blob_view(value), transient_binding);	}
+
+	inline void statement::bind(int index, const blob_view &value)
+	{	bind(index, value, transient_binding);	}
+
+	inline void statement::bind(int index, const std::vector<std::uint8_t> &value, binding_lifetime lifetime)
+	{	bind(index, blob_view(value), lifetime);	}
+
+	inline void statement::bind(int index, const blob_view &value, binding_lifetime lifetime)
+	{
+		if (value.empty())
+			sqlite3_bind_zeroblob(_underlying.get(), index, 0); // Binding a null pointer would bind NULL.
+		else
+			sqlite3_bind_blob(_underlying.get(), index, value.data(), static_cast<int>(value.size()),
+				lifetime == static_binding ? SQLITE_STATIC : SQLITE_TRANSIENT);
+	}
+
+	inline void statement::bind_zeroblob(int index, std::size_t size)
+	{	sqlite3_bind_zeroblob64(_underlying.get(), index, static_cast<sqlite3_uint64>(size));	}
+
+	inline int statement::parameter_index(const char *name) const
+	{	return sqlite3_bind_parameter_index(_underlying.get(), name);	}
 
 	inline statement::field_accessor statement::get(int index) const
 	{	return statement::field_accessor(*_underlying, index);	}
@@ -158,6 +304,20 @@ namespace sql2xx
 	inline statement::field_accessor::operator const char *() const
 	{	return reinterpret_cast<const char *>(sqlite3_column_text(&_statement, _index));	}
 
+	inline statement::field_accessor::operator text_view() const
+	{
+		const auto text = reinterpret_cast<const char *>(sqlite3_column_text(&_statement, _index));
+
+		return text ? text_view(text, static_cast<std::size_t>(sqlite3_column_bytes(&_statement, _index))) : text_view();
+	}
+
+	inline statement::field_accessor::operator blob_view() const
+	{
+		const auto data = sqlite3_column_blob(&_statement, _index);
+
+		return data ? blob_view(data, static_cast<std::size_t>(sqlite3_column_bytes(&_statement, _index))) : blob_view();
+	}
+
 	inline bool statement::field_accessor::has_value() const
 	{	return SQLITE_NULL != sqlite3_column_type(&_statement, _index);	}
 
@@ -0,0 +1,153 @@
+//	Copyright (c) 2011-2023 by Artem A. Gevorkyan (gevorkyan.org)
+//
+//	Permission is hereby granted, free of charge, to any person obtaining a copy
+//	of this software and associated documentation files (the "Software"), to deal
+//	in the Software without restriction, including without limitation the rights
+//	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//	copies of the Software, and to permit persons to whom the Software is
+//	furnished to do so, subject to the following conditions:
+//
+//	The above copyright notice and this permission notice shall be included in
+//	all copies or substantial portions of the Software.
+//
+//	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//	THE SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sql2xx
+{
+	struct statement_stats
+	{
+		statement_stats();
+
+		statement_stats &operator +=(const statement_stats &rhs);
+
+		std::uint64_t fullscan_steps, sorts, autoindexes, vm_steps, reprepares, runs;
+		std::uint64_t memory_used; // Bytes, the largest seen when aggregated.
+		std::uint64_t rows; // Rows produced.
+		std::uint64_t changes; // Rows inserted, updated or deleted directly, excluding trigger and cascade changes.
+		double execute_seconds; // Only tracked for connections collecting statistics.
+	};
+
+	// Aggregates statistics of statements executed on a connection by their SQL text.
+	class statement_registry
+	{
+	public:
+		typedef std::pair<std::string, statement_stats> entry;
+
+	public:
+		void record(const char *expression_text, const statement_stats &stats);
+		void clear();
+
+		std::size_t size() const;
+		const statement_stats *find(const char *expression_text) const;
+
+		template <typename F>
+		std::vector<entry> top(std::size_t n, F statement_stats::*by) const;
+		std::vector<entry> top(std::size_t n) const;
+
+	private:
+		std::unordered_map<std::string, statement_stats> _entries;
+		std::string _key;
+	};
+
+
+
+	inline void format_statistics_report(std::string &output, const std::vector<statement_registry::entry> &entries)
+	{
+		char buffer[256];
+
+		for (auto i = entries.begin(); i != entries.end(); ++i)
+		{
+			const auto &s = i->second;
+
+			std::snprintf(buffer, sizeof(buffer), "%10.6fs runs=%llu rows=%llu changes=%llu vm_steps=%llu "
+				"fullscan_steps=%llu sorts=%llu autoindexes=%llu reprepares=%llu memory=%llu: ", s.execute_seconds,
+				static_cast<unsigned long long>(s.runs), static_cast<unsigned long long>(s.rows),
+				static_cast<unsigned long long>(s.changes), static_cast<unsigned long long>(s.vm_steps),
+				static_cast<unsigned long long>(s.fullscan_steps), static_cast<unsigned long long>(s.sorts),
+				static_cast<unsigned long long>(s.autoindexes), static_cast<unsigned long long>(s.reprepares),
+				static_cast<unsigned long long>(s.memory_used));
+			output += buffer;
+			output += i->first;
+			output += '\n';
+		}
+	}
+
+
+	inline statement_stats::statement_stats()
+		: fullscan_steps(0), sorts(0), autoindexes(0), vm_steps(0), reprepares(0), runs(0), memory_used(0), rows(0),
+			changes(0), execute_seconds(0.0)
+	{	}
+
+	inline statement_stats &statement_stats::operator +=(const statement_stats &rhs)
+	{
+		fullscan_steps += rhs.fullscan_steps;
+		sorts += rhs.sorts;
+		autoindexes += rhs.autoindexes;
+		vm_steps += rhs.vm_steps;
+		reprepares += rhs.reprepares;
+		runs += rhs.runs;
+		memory_used = (std::max)(memory_used, rhs.memory_used);
+		rows += rhs.rows;
+		changes += rhs.changes;
+		execute_seconds += rhs.execute_seconds;
+		return *this;
+	}
+
+
+	inline void statement_registry::record(const char *expression_text, const statement_stats &stats)
+	{
+		_key.assign(expression_text);
+
+		const auto i = _entries.find(_key);
+
+		if (i != _entries.end())
+			i->second += stats;
+		else
+			_entries.insert(std::make_pair(_key, stats));
+	}
+
+	inline void statement_registry::clear()
+	{	_entries.clear();	}
+
+	inline std::size_t statement_registry::size() const
+	{	return _entries.size();	}
+
+	inline const statement_stats *statement_registry::find(const char *expression_text) const
+	{
+		const auto i = _entries.find(expression_text);
+
+		return i != _entries.end() ? &i->second : nullptr;
+	}
+
+	template <typename F>
+	inline std::vector<statement_registry::entry> statement_registry::top(std::size_t n, F statement_stats::*by) const
+	{
+		std::vector<entry> result(_entries.begin(), _entries.end());
+
+		n = (std::min)(n, result.size());
+		std::partial_sort(result.begin(), result.begin() + n, result.end(), [by] (const entry &lhs, const entry &rhs) {
+			return lhs.second.*by > rhs.second.*by;
+		});
+		result.resize(n);
+		return result;
+	}
+
+	inline std::vector<statement_registry::entry> statement_registry::top(std::size_t n) const
+	{	return top(n, &statement_stats::execute_seconds);	}
+}
@@ -25,6 +25,20 @@ namespace sql2xx
 	enum identity_tag {	identity	};
 	enum primary_key_tag {	primary	};
 	enum unique_tag {	unique	};
+	enum index_tag {	index	};
+
+	template <typename F>
+	struct descending
+	{
+		F field;
+	};
+
+	template <typename T, typename U>
+	inline descending<U T::*> desc(U T::*field)
+	{
+		descending<U T::*> d = {	field	};
+		return d;
+	}
 
 	template <typename ReferredT>
 	inline void foreign_key_cascade(ReferredT)
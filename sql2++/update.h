@@ -26,18 +26,64 @@
 
 namespace sql2xx
 {
+	template <typename W, typename ValuesT>
+	struct update_bindings
+	{
+		W where;
+		ValuesT values;
+		bool in_operand_assigned; // The operand of an IN predicate in 'where' is one of the fields assigned.
+	};
+
+	template <typename W, typename ValuesT>
 	class updater : statement
 	{
 	public:
-		updater(statement_ptr &&statement_, const std::function<void (statement &statement_)> &update_bindings);
+		updater(statement_ptr &&statement_, const update_bindings<W, ValuesT> &bindings);
 
-		using statement::execute;
+		std::int64_t execute(); // Returns the number of records changed.
+		using statement::stats;
 		void reset();
 
 	private:
-		const std::function<void (statement &statement_)> _update_bindings;
+		const update_bindings<W, ValuesT> _bindings;
+	};
+
+	// Collects references to the values assigned from a (field, value, field, value, ...) sequence into a tuple.
+	template <typename ValuesT, typename... RestT>
+	struct update_values;
+
+	template <typename... V>
+	struct update_values<std::tuple<const V &...>>
+	{
+		typedef std::tuple<const V &...> type;
+
+		static type collect(const type &values)
+		{	return values;	}
+	};
+
+	template <typename... V, typename FieldT, typename ValueT, typename... RestT>
+	struct update_values<std::tuple<const V &...>, FieldT, ValueT, RestT...>
+	{
+		typedef update_values<std::tuple<const V &..., const ValueT &>, RestT...> next;
+		typedef typename next::type type;
+
+		static type collect(const std::tuple<const V &...> &values, const FieldT &, const ValueT &value,
+			const RestT &... rest)
+		{	return next::collect(std::tuple_cat(values, std::tie(value)), rest...);	}
 	};
 
+	// Tells if a condition has an IN predicate over one of the fields assigned by a (field, value, field, value, ...)
+	// sequence. Executed chunk by chunk, such an update could match the records changed by the earlier chunks again.
+	template <typename E, typename... AssignmentsT>
+	bool in_operand_assigned(const E &where, const AssignmentsT &... assignments);
+
+	template <typename W, typename ValueT, typename... RestT>
+	struct updater_type
+	{
+		typedef update_values<std::tuple<const ValueT &>, typename std::decay<RestT>::type...> values;
+		typedef update_bindings<W, typename values::type> bindings;
+		typedef updater<W, typename values::type> type;
+	};
 
 	template <typename T>
 	class update_builder
@@ -46,7 +92,7 @@ namespace sql2xx
 		template <typename W, typename FieldT, typename U, typename ValueT, typename... RestT>
 		update_builder(const W &where, FieldT U::* field, const ValueT &value, RestT &&... rest);
 
-		updater create(sqlite3 &database) const;
+		const std::string &expression_text() const;
 
 	private:
 		template <typename FieldT, typename U, typename ValueT, typename... RestT>
@@ -55,78 +101,141 @@ namespace sql2xx
 		template <typename FieldT, typename U, typename ValueT>
 		void initialize(FieldT U::* field, const ValueT &value);
 
-		template <typename FieldT, typename U, typename ValueT>
-		void add_set_expression(int index, FieldT U::* field, const ValueT &value);
+		template <typename FieldT, typename U>
+		void add_set_expression(int index, FieldT U::* field);
 
 	private:
 		std::string _expression;
-		std::function<void (statement &statement_)> _update_bindings;
 		unsigned int _binding_index;
 	};
 
 
 
-	inline updater::updater(statement_ptr &&statement_,
-			const std::function<void (statement &statement_)> &update_bindings)
-		: statement(std::move(statement_)), _update_bindings(update_bindings)
-	{	_update_bindings(*this);	}
+	template <typename T, typename F>
+	inline bool same_field(F T::*lhs, F T::*rhs)
+	{	return lhs == rhs;	}
+
+	template <typename T, typename F, typename U, typename G>
+	inline bool same_field(F T::* /*lhs*/, G U::* /*rhs*/)
+	{	return false;	}
+
+	template <typename T, typename F>
+	inline bool is_assigned(F T::* /*field*/)
+	{	return false;	}
 
-	inline void updater::reset()
+	template <typename T, typename F, typename FieldT, typename U, typename ValueT, typename... RestT>
+	inline bool is_assigned(F T::*field, FieldT U::*assigned, const ValueT &/*value*/, const RestT &... rest)
+	{	return same_field(field, assigned) || is_assigned(field, rest...);	}
+
+	template <typename E, typename... AssignmentsT>
+	inline bool in_operand_assigned(const E &/*where*/, const AssignmentsT &... /*assignments*/)
+	{	return false;	}
+
+	template <typename E, typename R, typename... AssignmentsT>
+	inline bool in_operand_assigned(const wrapped<E, R> &where, const AssignmentsT &... assignments)
+	{	return in_operand_assigned(static_cast<const E &>(where), assignments...);	}
+
+	template <typename L, typename R, typename... AssignmentsT>
+	inline bool in_operand_assigned(const binary_operator<L, R> &where, const AssignmentsT &... assignments)
+	{
+		return in_operand_assigned(where.lhs, assignments...) || in_operand_assigned(where.rhs, assignments...);
+	}
+
+	template <typename U, typename... AssignmentsT>
+	inline bool in_operand_assigned(const unary_operator<U> &where, const AssignmentsT &... assignments)
+	{	return in_operand_assigned(where.operand, assignments...);	}
+
+	template <typename T, typename F, typename ContainerT, typename... AssignmentsT>
+	inline bool in_operand_assigned(const in_predicate<column<T, F>, ContainerT> &where,
+		const AssignmentsT &... assignments)
+	{	return is_assigned(where.operand.field, assignments...);	}
+
+
+	template <typename W, typename ValuesT>
+	inline void bind_parameters(statement &statement_, const update_bindings<W, ValuesT> &e, unsigned int &index)
+	{
+		bind_values(statement_, e.values, index);
+		bind_parameters(statement_, e.where, index);
+		if (e.in_operand_assigned && in_chunked(e.where))
+			throw sql_error("An IN list bound in chunks cannot be over a field being updated");
+	}
+
+	template <typename W, typename ValuesT>
+	inline void allow_in_chunks(const update_bindings<W, ValuesT> &e)
+	{	allow_in_chunks(e.where);	}
+
+	template <typename W, typename ValuesT>
+	inline bool in_chunked(const update_bindings<W, ValuesT> &e)
+	{	return in_chunked(e.where);	}
+
+	template <typename W, typename ValuesT>
+	inline bool next_in_chunk(const update_bindings<W, ValuesT> &e)
+	{	return next_in_chunk(e.where);	}
+
+
+	template <typename W, typename ValuesT>
+	inline updater<W, ValuesT>::updater(statement_ptr &&statement_, const update_bindings<W, ValuesT> &bindings)
+		: statement(std::move(statement_)), _bindings(bindings)
+	{
+		allow_in_chunks(_bindings);
+		bind_parameters(*this, _bindings);
+	}
+
+	template <typename W, typename ValuesT>
+	inline std::int64_t updater<W, ValuesT>::execute()
+	{
+		std::int64_t changed = 0;
+
+		for (;;)
+		{
+			statement::execute();
+			changed += changes();
+			if (!next_in_chunk(_bindings))
+				return changed;
+			reset();
+		}
+	}
+
+	template <typename W, typename ValuesT>
+	inline void updater<W, ValuesT>::reset()
 	{
 		statement::reset();
-		_update_bindings(*this);
+		bind_parameters(*this, _bindings);
 	}
 
 
 	template <typename T>
 	template <typename W, typename FieldT, typename U, typename ValueT, typename... RestT>
 	inline update_builder<T>::update_builder(const W &where, FieldT U::* field, const ValueT &value, RestT &&... rest)
-		: _expression("UPDATE " + default_table_name<T>() + " SET "), _update_bindings([] (statement &) {}),
-			_binding_index(1)
+		: _expression("UPDATE " + default_table_name<T>() + " SET "), _binding_index(1)
 	{
 		initialize(field, value, std::forward<RestT>(rest)...);
 		_expression += " WHERE ";
-
-		const auto where_index = _binding_index;
-		auto previous = _update_bindings;
-
 		format_expression(_expression, where, _binding_index);
-		_update_bindings = [where, where_index, previous] (statement &statement_) {
-			auto index = where_index;
-
-			previous(statement_);
-			sql2xx::bind_parameters(statement_, where, index);
-		};
 	}
 
 	template <typename T>
-	inline updater update_builder<T>::create(sqlite3 &database) const
-	{	return updater(sql2xx::create_statement(database, _expression.c_str()), _update_bindings);	}
+	inline const std::string &update_builder<T>::expression_text() const
+	{	return _expression;	}
 
 	template <typename T>
 	template <typename FieldT, typename U, typename ValueT, typename... RestT>
-	inline void update_builder<T>::initialize(FieldT U::* field, const ValueT &value, RestT &&... rest)
+	inline void update_builder<T>::initialize(FieldT U::* field, const ValueT &/*value*/, RestT &&... rest)
 	{
-		add_set_expression(_binding_index++, field, value);
+		add_set_expression(_binding_index++, field);
 		_expression += ',';
 		initialize(std::forward<RestT>(rest)...);
 	}
 
 	template <typename T>
 	template <typename FieldT, typename U, typename ValueT>
-	inline void update_builder<T>::initialize(FieldT U::* field, const ValueT &value)
-	{	add_set_expression(_binding_index++, field, value);	}
+	inline void update_builder<T>::initialize(FieldT U::* field, const ValueT &/*value*/)
+	{	add_set_expression(_binding_index++, field);	}
 
 	template <typename T>
-	template <typename FieldT, typename U, typename ValueT>
-	inline void update_builder<T>::add_set_expression(int index, FieldT U::* field, const ValueT &value)
+	template <typename FieldT, typename U>
+	inline void update_builder<T>::add_set_expression(int index, FieldT U::* field)
 	{
-		auto p = _update_bindings;
-
-		_update_bindings = [&value, p, index] (statement &statement_) {
-			p(statement_);
-			statement_.bind(index, value);
-		};
 		format_column(_expression, c(field));
 		_expression += "=:";
 		_expression += std::to_string(index);
@@ -0,0 +1,176 @@
+//	Copyright (c) 2011-2023 by Artem A. Gevorkyan (gevorkyan.org)
+//
+//	Permission is hereby granted, free of charge, to any person obtaining a copy
+//	of this software and associated documentation files (the "Software"), to deal
+//	in the Software without restriction, including without limitation the rights
+//	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//	copies of the Software, and to permit persons to whom the Software is
+//	furnished to do so, subject to the following conditions:
+//
+//	The above copyright notice and this permission notice shall be included in
+//	all copies or substantial portions of the Software.
+//
+//	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//	THE SOFTWARE.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+	#include <string_view>
+#endif
+
+namespace sql2xx
+{
+	// A non-owning view of a text value. When read from a database it points directly to the memory of the column
+	// value, so it is only valid until the reader advances to the next row or is destroyed.
+	class text_view
+	{
+	public:
+		text_view();
+		text_view(const char *text);
+		text_view(const char *text, std::size_t length);
+		text_view(const std::string &text);
+
+		const char *data() const;
+		std::size_t size() const;
+		bool empty() const;
+
+		const char *begin() const;
+		const char *end() const;
+
+		std::string str() const;
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+		operator std::string_view() const
+		{	return std::string_view(_data, _size);	}
+#endif
+
+	private:
+		const char *_data;
+		std::size_t _size;
+	};
+
+	// A non-owning view of a binary value. The same lifetime rules as for text_view apply.
+	class blob_view
+	{
+	public:
+		blob_view();
+		blob_view(const void *data_, std::size_t size_);
+		blob_view(const std::vector<std::uint8_t> &data_);
+
+		const std::uint8_t *data() const;
+		std::size_t size() const;
+		bool empty() const;
+
+		const std::uint8_t *begin() const;
+		const std::uint8_t *end() const;
+
+		std::vector<std::uint8_t> vector() const;
+
+	private:
+		const std::uint8_t *_data;
+		std::size_t _size;
+	};
+
+
+
+	inline text_view::text_view()
+		: _data(""), _size(0)
+	{	}
+
+	inline text_view::text_view(const char *text)
+		: _data(text), _size(std::strlen(text))
+	{	}
+
+	inline text_view::text_view(const char *text, std::size_t length)
+		: _data(text), _size(length)
+	{	}
+
+	inline text_view::text_view(const std::string &text)
+		: _data(text.data()), _size(text.size())
+	{	}
+
+	inline const char *text_view::data() const
+	{	return _data;	}
+
+	inline std::size_t text_view::size() const
+	{	return _size;	}
+
+	inline bool text_view::empty() const
+	{	return !_size;	}
+
+	inline const char *text_view::begin() const
+	{	return _data;	}
+
+	inline const char *text_view::end() const
+	{	return _data + _size;	}
+
+	inline std::string text_view::str() const
+	{	return std::string(_data, _size);	}
+
+
+	inline blob_view::blob_view()
+		: _data(nullptr), _size(0)
+	{	}
+
+	inline blob_view::blob_view(const void *data_, std::size_t size_)
+		: _data(static_cast<const std::uint8_t *>(data_)), _size(size_)
+	{	}
+
+	inline blob_view::blob_view(const std::vector<std::uint8_t> &data_)
+		: _data(data_.data()), _size(data_.size())
+	{	}
+
+	inline const std::uint8_t *blob_view::data() const
+	{	return _data;	}
+
+	inline std::size_t blob_view::size() const
+	{	return _size;	}
+
+	inline bool blob_view::empty() const
+	{	return !_size;	}
+
+	inline const std::uint8_t *blob_view::begin() const
+	{	return _data;	}
+
+	inline const std::uint8_t *blob_view::end() const
+	{	return _data + _size;	}
+
+	inline std::vector<std::uint8_t> blob_view::vector() const
+	{	return std::vector<std::uint8_t>(begin(), end());	}
+
+
+	inline bool operator ==(const text_view &lhs, const text_view &rhs)
+	{	return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());	}
+
+	inline bool operator !=(const text_view &lhs, const text_view &rhs)
+	{	return !(lhs == rhs);	}
+
+	inline bool operator <(const text_view &lhs, const text_view &rhs)
+	{
+		const auto r = std::memcmp(lhs.data(), rhs.data(), (std::min)(lhs.size(), rhs.size()));
+
+		return r < 0 || (!r && lhs.size() < rhs.size());
+	}
+
+	inline bool operator ==(const blob_view &lhs, const blob_view &rhs)
+	{	return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());	}
+
+	inline bool operator !=(const blob_view &lhs, const blob_view &rhs)
+	{	return !(lhs == rhs);	}
+
+	inline bool operator <(const blob_view &lhs, const blob_view &rhs)
+	{	return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());	}
+}
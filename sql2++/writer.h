@@ -0,0 +1,392 @@
+//	Copyright (c) 2011-2023 by Artem A. Gevorkyan (gevorkyan.org)
+//
+//	Permission is hereby granted, free of charge, to any person obtaining a copy
+//	of this software and associated documentation files (the "Software"), to deal
+//	in the Software without restriction, including without limitation the rights
+//	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+//	copies of the Software, and to permit persons to whom the Software is
+//	furnished to do so, subject to the following conditions:
+//
+//	The above copyright notice and this permission notice shall be included in
+//	all copies or substantial portions of the Software.
+//
+//	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+//	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+//	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+//	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+//	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+//	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+//	THE SOFTWARE.
+
+#pragma once
+
+#include "database.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace sql2xx
+{
+	struct async_writer_options
+	{
+		async_writer_options();
+
+		std::size_t max_batch_size;
+		std::chrono::microseconds max_latency; // How long to wait for more work once the first item of a batch arrived.
+	};
+
+	// Executes write work items submitted from any thread on a dedicated thread, committing them in batches. Each item
+	// runs in its own savepoint, so a failing item does not affect the rest of the batch. Futures returned complete
+	// once the batch containing the item is committed.
+	class async_writer
+	{
+	public:
+		async_writer(const connection_ptr &connection, const async_writer_options &options = async_writer_options());
+		async_writer(const connection_lease &lease, const async_writer_options &options = async_writer_options());
+		~async_writer();
+
+		template <typename T>
+		std::future<T> insert(const T &record);
+
+		// Write a record back or remove it by its identity. Futures complete with the number of records changed.
+		template <typename T>
+		std::future<std::size_t> update(const T &record);
+
+		template <typename T>
+		std::future<std::size_t> remove(const T &record);
+
+		// Work is invoked on the writer thread, so whatever it refers to (e.g. parameters passed via p()) must be
+		// captured by value.
+		std::future<void> submit(const std::function<void (transaction &t)> &work);
+
+		std::uint64_t batches() const;
+
+	private:
+		struct work_item
+		{
+			virtual ~work_item() {	}
+			virtual void execute(transaction &t) = 0;
+			virtual void succeed() = 0;
+			virtual void fail(std::exception_ptr e) = 0;
+
+			std::atomic<work_item *> next;
+			std::exception_ptr error;
+		};
+
+		struct stub_item : work_item
+		{
+			virtual void execute(transaction &) {	}
+			virtual void succeed() {	}
+			virtual void fail(std::exception_ptr) {	}
+		};
+
+		template <typename T>
+		struct insert_item;
+		template <typename T, bool remove>
+		struct record_item;
+		struct generic_item;
+
+		struct savepoint
+		{
+			savepoint(const connection_ptr &connection);
+
+			statement begin, release, rollback;
+		};
+
+	private:
+		async_writer(const async_writer &other);
+		void operator =(const async_writer &rhs);
+
+		void start();
+		void push(work_item *item);
+		work_item *pop();
+		bool wait_until(std::chrono::steady_clock::time_point deadline);
+		void run();
+		void execute_batch(std::vector<work_item *> &batch, savepoint &item_savepoint);
+
+	private:
+		const async_writer_options _options;
+		std::shared_ptr<void> _lease;
+		connection_ptr _connection;
+		std::atomic<work_item *> _head; // Producers push here...
+		work_item *_tail; // ...and the writer thread pops from here.
+		stub_item _stub;
+		std::mutex _mtx;
+		std::condition_variable _wakeup;
+		std::atomic<bool> _sleeping, _stopping;
+		std::atomic<std::uint64_t> _batches;
+		std::thread _thread;
+	};
+
+	template <typename T>
+	struct async_writer::insert_item : work_item
+	{
+		insert_item(const T &record_)
+			: record(record_)
+		{	}
+
+		virtual void execute(transaction &t)
+		{	t.insert<T>()(record);	}
+
+		virtual void succeed()
+		{	promise.set_value(record);	}
+
+		virtual void fail(std::exception_ptr e)
+		{	promise.set_exception(e);	}
+
+		T record;
+		std::promise<T> promise;
+	};
+
+	template <typename T, bool remove>
+	struct async_writer::record_item : work_item
+	{
+		record_item(const T &record_)
+			: record(record_), changed(0)
+		{	}
+
+		virtual void execute(transaction &t)
+		{	changed = remove ? t.remove_records<T>(&record, &record + 1) : t.update_records<T>(&record, &record + 1);	}
+
+		virtual void succeed()
+		{	promise.set_value(changed);	}
+
+		virtual void fail(std::exception_ptr e)
+		{	promise.set_exception(e);	}
+
+		T record;
+		std::size_t changed;
+		std::promise<std::size_t> promise;
+	};
+
+	struct async_writer::generic_item : work_item
+	{
+		generic_item(const std::function<void (transaction &t)> &work_)
+			: work(work_)
+		{	}
+
+		virtual void execute(transaction &t)
+		{	work(t);	}
+
+		virtual void succeed()
+		{	promise.set_value();	}
+
+		virtual void fail(std::exception_ptr e)
+		{	promise.set_exception(e);	}
+
+		std::function<void (transaction &t)> work;
+		std::promise<void> promise;
+	};
+
+
+
+	inline async_writer_options::async_writer_options()
+		: max_batch_size(256), max_latency(2000)
+	{	}
+
+
+	inline async_writer::savepoint::savepoint(const connection_ptr &connection)
+		: begin(create_statement(connection, "SAVEPOINT sql2xx_item")),
+			release(create_statement(connection, "RELEASE sql2xx_item")),
+			rollback(create_statement(connection, "ROLLBACK TO sql2xx_item"))
+	{	}
+
+
+	inline async_writer::async_writer(const connection_ptr &connection, const async_writer_options &options)
+		: _options(options), _connection(connection)
+	{	start();	}
+
+	inline async_writer::async_writer(const connection_lease &lease, const async_writer_options &options)
+		: _options(options), _lease(lease.token()), _connection(lease.connection())
+	{	start();	}
+
+	inline async_writer::~async_writer()
+	{
+		_stopping = true;
+		{
+			std::lock_guard<std::mutex> l(_mtx);
+			_wakeup.notify_one();
+		}
+		_thread.join();
+	}
+
+	template <typename T>
+	inline std::future<T> async_writer::insert(const T &record)
+	{
+		auto item = new insert_item<T>(record);
+		auto f = item->promise.get_future();
+
+		push(item);
+		return f;
+	}
+
+	template <typename T>
+	inline std::future<std::size_t> async_writer::update(const T &record)
+	{
+		auto item = new record_item<T, false>(record);
+		auto f = item->promise.get_future();
+
+		push(item);
+		return f;
+	}
+
+	template <typename T>
+	inline std::future<std::size_t> async_writer::remove(const T &record)
+	{
+		auto item = new record_item<T, true>(record);
+		auto f = item->promise.get_future();
+
+		push(item);
+		return f;
+	}
+
+	inline std::future<void> async_writer::submit(const std::function<void (transaction &t)> &work)
+	{
+		auto item = new generic_item(work);
+		auto f = item->promise.get_future();
+
+		push(item);
+		return f;
+	}
+
+	inline std::uint64_t async_writer::batches() const
+	{	return _batches.load();	}
+
+	inline void async_writer::start()
+	{
+		if (!_options.max_batch_size)
+			throw std::invalid_argument("Batches of an asynchronous writer must allow at least one item");
+		_stub.next = nullptr;
+		_head = &_stub;
+		_tail = &_stub;
+		_sleeping = false;
+		_stopping = false;
+		_batches = 0;
+		_thread = std::thread([this] {	run();	});
+	}
+
+	inline void async_writer::push(work_item *item)
+	{
+		item->next.store(nullptr, std::memory_order_relaxed);
+		_head.exchange(item)->next.store(item, std::memory_order_release);
+		if (_sleeping)
+		{
+			std::lock_guard<std::mutex> l(_mtx);
+			_wakeup.notify_one();
+		}
+	}
+
+	inline async_writer::work_item *async_writer::pop()
+	{
+		auto tail = _tail;
+		auto next = tail->next.load(std::memory_order_acquire);
+
+		if (tail == &_stub)
+		{
+			if (!next)
+				return nullptr;
+			_tail = tail = next;
+			next = next->next.load(std::memory_order_acquire);
+		}
+		if (next)
+			return _tail = next, tail;
+		if (tail != _head.load())
+			return nullptr; // A producer is in the middle of pushing.
+		push(&_stub);
+		next = tail->next.load(std::memory_order_acquire);
+		return next ? _tail = next, tail : nullptr;
+	}
+
+	inline bool async_writer::wait_until(std::chrono::steady_clock::time_point deadline)
+	{
+		std::unique_lock<std::mutex> l(_mtx);
+
+		_sleeping = true;
+		if (_tail != &_stub || _head.load() != &_stub || _stopping)
+			return _sleeping = false, true;
+		_wakeup.wait_until(l, deadline);
+		_sleeping = false;
+		return std::chrono::steady_clock::now() < deadline;
+	}
+
+	inline void async_writer::run()
+	{
+		std::vector<work_item *> batch;
+		savepoint item_savepoint(_connection); // Prepared once: executed around every item.
+
+		for (;;)
+		{
+			while (batch.size() < _options.max_batch_size)
+			{
+				if (auto item = pop())
+					batch.push_back(item);
+				else if (batch.empty() && _stopping)
+					return;
+				else if (batch.empty())
+					wait_until(std::chrono::steady_clock::now() + std::chrono::milliseconds(100));
+				else
+					break;
+			}
+
+			const auto deadline = std::chrono::steady_clock::now() + _options.max_latency;
+
+			while (batch.size() < _options.max_batch_size && !_stopping)
+			{
+				if (auto item = pop())
+					batch.push_back(item);
+				else if (!wait_until(deadline))
+					break;
+			}
+			execute_batch(batch, item_savepoint);
+		}
+	}
+
+	inline void async_writer::execute_batch(std::vector<work_item *> &batch, savepoint &item_savepoint)
+	{
+		const auto step = [] (statement &s) {
+			s.execute();
+			s.reset();
+		};
+
+		try
+		{
+			transaction t(_connection, transaction::immediate);
+
+			for (auto i = batch.begin(); i != batch.end(); ++i)
+			{
+				step(item_savepoint.begin);
+				try
+				{
+					(*i)->execute(t);
+					step(item_savepoint.release);
+				}
+				catch (...)
+				{
+					(*i)->error = std::current_exception();
+					step(item_savepoint.rollback);
+					step(item_savepoint.release);
+				}
+			}
+			t.commit();
+			_batches++;
+			for (auto i = batch.begin(); i != batch.end(); ++i)
+				(*i)->error ? (*i)->fail((*i)->error) : (*i)->succeed();
+		}
+		catch (...)
+		{
+			for (auto i = batch.begin(); i != batch.end(); ++i)
+				(*i)->fail((*i)->error ? (*i)->error : std::current_exception());
+		}
+		for (auto i = batch.begin(); i != batch.end(); ++i)
+			delete *i;
+		batch.clear();
+	}
+}
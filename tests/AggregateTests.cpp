@@ -0,0 +1,188 @@
+#include <sql2++/database.h>
+
+#include "file_helpers.h"
+#include "helpers.h"
+
+#include <ut/assert.h>
+#include <ut/test.h>
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		namespace
+		{
+			struct sale
+			{
+				string region;
+				string product;
+				int quantity;
+				double price;
+				nullable<int> discount;
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, sale *)
+			{
+				visitor("sales");
+				visitor(&sale::region, "region");
+				visitor(&sale::product, "product");
+				visitor(&sale::quantity, "quantity");
+				visitor(&sale::price, "price");
+				visitor(&sale::discount, "discount");
+			}
+
+			template <typename ReaderT, typename T>
+			vector<T> read_projection(ReaderT &&r, T item)
+			{
+				vector<T> result;
+
+				while (r(item))
+					result.push_back(item);
+				return result;
+			}
+		}
+
+		begin_test_suite( AggregateTests )
+			temporary_directory dir;
+			string path;
+
+			init( CreateSamples )
+			{
+				path = dir.track_file("sample-db.db");
+
+				transaction t(create_connection(path.c_str()));
+				auto sales = plural
+					+ initialize<sale>("north", "apple", 10, 1.5, nullable<int>(5))
+					+ initialize<sale>("north", "pear", 4, 2.0, nullable<int>())
+					+ initialize<sale>("south", "apple", 7, 1.25, nullable<int>())
+					+ initialize<sale>("south", "plum", 1, 3.0, nullable<int>(10))
+					+ initialize<sale>("south", "pear", 2, 2.5, nullable<int>())
+					+ initialize<sale>("west", "apple", 20, 1.0, nullable<int>());
+
+				t.create_table<sale>();
+				write_all(t, sales);
+				t.commit();
+			}
+
+
+			test( AggregatesOverAWholeTableAreCalculatedBySQLite )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+
+				// ACT
+				auto r = read_projection(t.select(sum(c(&sale::quantity)), min(c(&sale::price)), max(c(&sale::product)),
+					avg(c(&sale::quantity)), count(c(&sale::discount)), count()).all(),
+					tuple<int64_t, double, string, double, int64_t, int64_t>());
+
+				// ASSERT
+				assert_equal(1u, r.size());
+				assert_equal(44, get<0>(r[0]));
+				assert_equal(1.0, get<1>(r[0]));
+				assert_equal("plum", get<2>(r[0]));
+				assert_approx_equal(44.0 / 6, get<3>(r[0]), 0.0001);
+				assert_equal(2, get<4>(r[0]));
+				assert_equal(6, get<5>(r[0]));
+			}
+
+
+			test( SumsOfRealColumnsAreReal )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				string region = "south";
+
+				// ACT
+				auto r = read_projection(t.select(sum(c(&sale::price))).where(c(&sale::region) == p(region)),
+					tuple<double>());
+
+				// ASSERT
+				assert_equal(plural + make_tuple(6.75), r);
+			}
+
+
+			test( RecordsAreGroupedAndOrdered )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+
+				// ACT
+				auto r = read_projection(t.select(c(&sale::region), sum(c(&sale::quantity)), count())
+					.all(group_by(c(&sale::region)), c(&sale::region), false),
+					tuple<string, int64_t, int64_t>());
+
+				// ASSERT
+				assert_equal(plural
+					+ make_tuple(string("west"), (int64_t)20, (int64_t)1)
+					+ make_tuple(string("south"), (int64_t)10, (int64_t)3)
+					+ make_tuple(string("north"), (int64_t)14, (int64_t)2), r);
+			}
+
+
+			test( GroupsAreFilteredWithHavingAfterWhere )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				string excluded = "plum";
+				int64_t min_quantity = 9;
+
+				// ACT
+				auto r = read_projection(t.select(c(&sale::region), sum(c(&sale::quantity)))
+					.where(c(&sale::product) != p(excluded), group_by(c(&sale::region)),
+						having(sum(c(&sale::quantity)) > p(min_quantity)), c(&sale::region), true, limit(5)),
+					tuple<string, int64_t>());
+
+				// ASSERT
+				assert_equal(plural
+					+ make_tuple(string("north"), (int64_t)14)
+					+ make_tuple(string("west"), (int64_t)20), r);
+			}
+
+
+			test( ParametersOfTheSelectListAreBoundBeforeTheRest )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				string product = "apple";
+				int lower = 2;
+				int64_t min_rows = 1;
+
+				// ACT
+				auto r1 = read_projection(t.select(sum(c(&sale::product) == p(product))).all(), tuple<int64_t>());
+				auto r2 = read_projection(t.select(c(&sale::region), sum(c(&sale::product) == p(product)),
+					sum(c(&sale::quantity)))
+					.where(c(&sale::quantity) >= p(lower), group_by(c(&sale::region)), having(count() > p(min_rows)),
+						c(&sale::region), true), tuple<string, int64_t, int64_t>());
+
+				// ASSERT
+				assert_equal(plural + make_tuple((int64_t)3), r1);
+				assert_equal(plural
+					+ make_tuple(string("north"), (int64_t)1, (int64_t)14)
+					+ make_tuple(string("south"), (int64_t)1, (int64_t)9), r2);
+			}
+
+
+			test( ValuesAreConcatenatedPerGroup )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				string region = "north";
+
+				// ACT
+				auto r1 = read_projection(t.select(group_concat(c(&sale::product), "|"))
+					.where(c(&sale::region) == p(region)), tuple<string>());
+				auto r2 = read_projection(t.select(c(&sale::product), group_concat(c(&sale::region)))
+					.all(group_by(c(&sale::product)), having(count() > lit(2))), tuple<string, string>());
+
+				// ASSERT
+				assert_equal(plural + make_tuple(string("apple|pear")), r1);
+				assert_equal(1u, r2.size());
+				assert_equal("apple", get<0>(r2[0]));
+				assert_equal(string("north,south,west").size(), get<1>(r2[0]).size()); // Order is unspecified.
+			}
+		end_test_suite
+	}
+}
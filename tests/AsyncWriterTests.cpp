@@ -0,0 +1,287 @@
+#include <sql2++/writer.h>
+
+#include "file_helpers.h"
+#include "helpers.h"
+
+#include <ut/assert.h>
+#include <ut/test.h>
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		namespace
+		{
+			struct event
+			{
+				int id;
+				string source;
+				int value;
+
+				bool operator <(const event &rhs) const
+				{	return make_tuple(id, source, value) < make_tuple(rhs.id, rhs.source, rhs.value);	}
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, event *)
+			{
+				visitor("events");
+				visitor(identity, &event::id, "id");
+				visitor(&event::source, "source");
+				visitor(&event::value, "value");
+			}
+		}
+
+		begin_test_suite( AsyncWriterTests )
+			temporary_directory dir;
+			string path;
+
+			init( CreateSamples )
+			{
+				path = dir.track_file("sample-db.db");
+
+				transaction t(create_connection(path.c_str()));
+
+				t.create_table<event>();
+				t.commit();
+			}
+
+
+			test( InsertedRecordsAreCommittedBeforeFuturesComplete )
+			{
+				// INIT
+				async_writer w(create_connection(path.c_str(), connection_options::tuned()));
+
+				// ACT
+				auto f1 = w.insert(initialize<event>(0, "a", 1));
+				auto f2 = w.insert(initialize<event>(0, "b", 2));
+				auto r1 = f1.get();
+				auto r2 = f2.get();
+
+				// ASSERT
+				transaction t(create_connection(path.c_str()));
+
+				assert_equal(1, r1.id);
+				assert_equal(2, r2.id);
+				assert_equivalent(plural + r1 + r2, read_all<event>(t));
+			}
+
+
+			test( ItemsFromManyThreadsAreCoalescedIntoBatches )
+			{
+				// INIT
+				async_writer_options o;
+				vector<thread> threads;
+				vector< future<event> > futures[8];
+
+				o.max_latency = chrono::milliseconds(20);
+
+				async_writer w(create_connection(path.c_str(), connection_options::tuned()), o);
+
+				// ACT
+				for (int n = 0; n != 8; ++n)
+				{
+					threads.push_back(thread([&w, &futures, n] {
+						for (int k = 0; k != 100; ++k)
+							futures[n].push_back(w.insert(initialize<event>(0, to_string(n), k)));
+					}));
+				}
+				for (auto i = threads.begin(); i != threads.end(); ++i)
+					i->join();
+
+				vector<int> ids;
+
+				for (int n = 0; n != 8; ++n)
+				{
+					for (auto i = futures[n].begin(); i != futures[n].end(); ++i)
+						ids.push_back(i->get().id);
+				}
+
+				// ASSERT
+				transaction t(create_connection(path.c_str()));
+
+				sort(ids.begin(), ids.end());
+				assert_equal(800u, t.count<event>());
+				assert_equal(800u, static_cast<size_t>(std::unique(ids.begin(), ids.end()) - ids.begin()));
+				assert_is_true(w.batches() < 800u);
+			}
+
+
+			test( BatchSizeIsLimited )
+			{
+				// INIT
+				async_writer_options o;
+				vector< future<event> > futures;
+
+				o.max_batch_size = 1;
+				o.max_latency = chrono::milliseconds(50);
+
+				async_writer w(create_connection(path.c_str()), o);
+
+				// ACT
+				for (int k = 0; k != 10; ++k)
+					futures.push_back(w.insert(initialize<event>(0, "a", k)));
+				for (auto i = futures.begin(); i != futures.end(); ++i)
+					i->get();
+
+				// ASSERT
+				assert_equal(10u, w.batches());
+			}
+
+
+			test( EmptyBatchSizeIsRejected )
+			{
+				// INIT
+				async_writer_options o;
+				connection_pool pool(path.c_str(), 1);
+
+				o.max_batch_size = 0;
+
+				// ACT / ASSERT
+				assert_throws(async_writer(create_connection(path.c_str()), o), invalid_argument);
+				assert_throws(async_writer(pool.write(), o), invalid_argument);
+
+				// ACT
+				async_writer w(pool.write());
+
+				// ASSERT
+				assert_equal(2u, pool.metrics().writer_checkouts);
+			}
+
+
+			test( FailingItemDoesNotAffectTheRestOfTheBatch )
+			{
+				// INIT
+				async_writer_options o;
+
+				o.max_latency = chrono::milliseconds(50);
+
+				async_writer w(create_connection(path.c_str()), o);
+
+				// ACT
+				auto f1 = w.insert(initialize<event>(0, "a", 1));
+				auto f2 = w.submit([] (transaction &t) {
+					auto e = initialize<event>(0, "b", 2);
+
+					t.insert<event>()(e);
+					throw runtime_error("failed");
+				});
+				auto f3 = w.insert(initialize<event>(0, "c", 3));
+
+				// ASSERT
+				assert_equal(1, f1.get().id);
+				assert_throws(f2.get(), runtime_error);
+				f3.get();
+
+				transaction t(create_connection(path.c_str()));
+				auto read = read_all<event>(t);
+
+				assert_equal(2u, read.size());
+				assert_equal(1u, t.count<event>(c(&event::source) == p<const string>("c")));
+				assert_equal(0u, t.count<event>(c(&event::source) == p<const string>("b")));
+			}
+
+
+			test( UpdatesAndRemovalsAreSubmittedAsWork )
+			{
+				// INIT
+				async_writer w(create_connection(path.c_str()));
+
+				w.insert(initialize<event>(0, "a", 1));
+				w.insert(initialize<event>(0, "b", 2));
+				w.insert(initialize<event>(0, "c", 3));
+
+				// ACT
+				auto f1 = w.submit([] (transaction &t) {
+					const string source = "a";
+					const int value = 10;
+
+					t.update<event>(c(&event::source) == p(source), &event::value, value).execute();
+				});
+				auto f2 = w.submit([] (transaction &t) {
+					const string source = "b";
+
+					t.remove<event>(c(&event::source) == p(source)).execute();
+				});
+
+				f1.get();
+				f2.get();
+
+				// ASSERT
+				transaction t(create_connection(path.c_str()));
+
+				assert_equivalent(plural
+					+ initialize<event>(1, "a", 10)
+					+ initialize<event>(3, "c", 3), read_all<event>(t));
+			}
+
+
+			test( RecordsAreUpdatedAndRemovedByIdentity )
+			{
+				// INIT
+				async_writer w(create_connection(path.c_str()));
+				auto a = w.insert(initialize<event>(0, "a", 1)).get();
+				auto b = w.insert(initialize<event>(0, "b", 2)).get();
+				auto c = w.insert(initialize<event>(0, "c", 3)).get();
+				auto missing = initialize<event>(100, "z", 0);
+
+				a.value = 10;
+
+				// ACT
+				auto f1 = w.update(a);
+				auto f2 = w.remove(b);
+				auto f3 = w.update(missing);
+				auto f4 = w.remove(missing);
+
+				// ASSERT
+				assert_equal(1u, f1.get());
+				assert_equal(1u, f2.get());
+				assert_equal(0u, f3.get());
+				assert_equal(0u, f4.get());
+
+				transaction t(create_connection(path.c_str()));
+
+				assert_equivalent(plural + a + c, read_all<event>(t));
+			}
+
+
+			test( PendingItemsAreWrittenOnDestruction )
+			{
+				// INIT
+				unique_ptr<async_writer> w(new async_writer(create_connection(path.c_str())));
+
+				for (int k = 0; k != 50; ++k)
+					w->insert(initialize<event>(0, "a", k));
+
+				// ACT
+				w.reset();
+
+				// ASSERT
+				transaction t(create_connection(path.c_str()));
+
+				assert_equal(50u, t.count<event>());
+			}
+
+
+			test( WriterIsCreatedFromPooledLease )
+			{
+				// INIT
+				connection_pool pool(path.c_str(), 1);
+
+				// INIT / ACT
+				async_writer w(pool.write());
+
+				// ACT
+				w.insert(initialize<event>(0, "a", 1)).get();
+
+				// ASSERT
+				transaction t(pool.read());
+
+				assert_equal(1u, t.count<event>());
+				assert_equal(1u, pool.metrics().writer_checkouts);
+			}
+		end_test_suite
+	}
+}
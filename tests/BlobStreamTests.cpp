@@ -0,0 +1,200 @@
+#include <sql2++/database.h>
+
+#include "file_helpers.h"
+#include "helpers.h"
+
+#include <ut/assert.h>
+#include <ut/test.h>
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		namespace
+		{
+			struct document
+			{
+				int id;
+				string name;
+				vector<uint8_t> content;
+
+				bool operator <(const document &rhs) const
+				{	return make_tuple(id, name, content) < make_tuple(rhs.id, rhs.name, rhs.content);	}
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, document *)
+			{
+				visitor("documents");
+				visitor(identity, &document::id, "id");
+				visitor(&document::name, "name");
+				visitor(&document::content, "content");
+			}
+
+			struct attachment
+			{
+				int id;
+				vector<uint8_t> data, preview;
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, attachment *)
+			{
+				visitor("attachments");
+				visitor(identity, &attachment::id, "id");
+				visitor(&attachment::data, "data");
+			}
+
+			vector<uint8_t> pattern(size_t size, uint8_t seed)
+			{
+				vector<uint8_t> r(size);
+
+				for (size_t i = 0; i != size; ++i)
+					r[i] = static_cast<uint8_t>(seed + i * 7);
+				return r;
+			}
+		}
+
+		begin_test_suite( BlobStreamTests )
+			temporary_directory dir;
+			string path;
+
+			init( CreateSamples )
+			{
+				path = dir.track_file("sample-db.db");
+
+				transaction t(create_connection(path.c_str()));
+
+				t.create_table<document>();
+				t.create_table<attachment>();
+				t.commit();
+			}
+
+
+			test( ZeroBlobIsInsertedAndFilledInChunks )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				const auto data = pattern(100000, 3);
+				document d = {	0, "large"	};
+
+				// ACT
+				{
+					auto s = t.insert_zeroblob<document>(d, &document::content, data.size());
+
+					// ASSERT
+					assert_equal(1, d.id);
+					assert_equal(data.size(), s.size());
+
+					// ACT
+					for (size_t offset = 0; offset < data.size(); offset += 4096)
+						s.write(offset, data.data() + offset, std::min<size_t>(4096, data.size() - offset));
+				}
+
+				// ASSERT
+				assert_equivalent(plural + initialize<document>(1, "large", data), read_all<document>(t));
+			}
+
+
+			test( RangesAreReadFromExistingBlobs )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				auto items = plural
+					+ initialize<document>(0, "a", pattern(1000, 1))
+					+ initialize<document>(0, "b", pattern(5000, 9));
+				vector<uint8_t> buffer(100);
+
+				write_all(t, items);
+
+				// INIT / ACT
+				auto s = t.open_blob<document>(&document::content, items[1].id);
+
+				// ACT
+				s.read(1234, buffer.data(), buffer.size());
+
+				// ASSERT
+				assert_equal(5000u, s.size());
+				assert_equal(vector<uint8_t>(items[1].content.begin() + 1234, items[1].content.begin() + 1334), buffer);
+
+				// ACT
+				s.reopen(items[0].id);
+				s.read(0, buffer.data(), buffer.size());
+
+				// ASSERT
+				assert_equal(1000u, s.size());
+				assert_equal(vector<uint8_t>(items[0].content.begin(), items[0].content.begin() + 100), buffer);
+			}
+
+
+			test( BlobIsModifiedInPlace )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				auto items = plural + initialize<document>(0, "a", vector<uint8_t>(10, 0));
+				const uint8_t patch[] = {	1, 2, 3,	};
+
+				write_all(t, items);
+
+				// ACT
+				t.open_blob<document>(&document::content, 1, true).write(4, patch, 3);
+
+				// ASSERT
+				items[0].content[4] = 1, items[0].content[5] = 2, items[0].content[6] = 3;
+				assert_equivalent(items, read_all<document>(t));
+			}
+
+
+			test( OpeningMissingRowOrReadingOutOfRangeThrows )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				auto items = plural + initialize<document>(0, "a", vector<uint8_t>(5, 0));
+				uint8_t buffer[10];
+
+				write_all(t, items);
+
+				// ACT / ASSERT
+				assert_throws(t.open_blob<document>(&document::content, 2), execution_error);
+
+				// INIT
+				auto s = t.open_blob<document>(&document::content, 1);
+
+				// ACT / ASSERT
+				assert_throws(s.read(0, buffer, 10), execution_error);
+				assert_throws(s.reopen(3), execution_error);
+			}
+
+
+			test( WritingToReadOnlyStreamThrows )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				auto items = plural + initialize<document>(0, "a", vector<uint8_t>(5, 0));
+				const uint8_t data[] = {	1,	};
+
+				write_all(t, items);
+
+				// INIT / ACT
+				auto s = t.open_blob<document>(&document::content, 1);
+
+				// ACT / ASSERT
+				assert_throws(s.write(0, data, 1), execution_error);
+			}
+
+
+			test( InsertingZeroBlobIntoAnUndescribedFieldThrows )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				attachment a = {	0, vector<uint8_t>(3, 1), vector<uint8_t>()	};
+
+				// ACT / ASSERT
+				assert_throws(t.insert_zeroblob<attachment>(a, &attachment::preview, 100), sql_error);
+				assert_equal(0u, t.count<attachment>());
+			}
+		end_test_suite
+	}
+}
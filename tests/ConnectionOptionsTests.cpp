@@ -0,0 +1,216 @@
+#include <sql2++/database.h>
+
+#include "file_helpers.h"
+#include "helpers.h"
+
+#include <ut/assert.h>
+#include <ut/test.h>
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		namespace
+		{
+			struct item
+			{
+				int id;
+				string name;
+
+				bool operator <(const item &rhs) const
+				{	return make_tuple(id, name) < make_tuple(rhs.id, rhs.name);	}
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, item *)
+			{
+				visitor("items");
+				visitor(identity, &item::id, "id");
+				visitor(&item::name, "name");
+			}
+
+			string pragma(const connection_ptr &connection, const char *name)
+			{
+				statement s(create_statement(*connection, (string("PRAGMA ") + name).c_str()));
+
+				s.execute();
+				return static_cast<const char *>(s.get(0));
+			}
+		}
+
+		begin_test_suite( ConnectionOptionsTests )
+			temporary_directory dir;
+			string path;
+
+			init( CreatePath )
+			{
+				path = dir.track_file("sample-db.db");
+			}
+
+
+			test( DefaultOptionsLeaveSQLiteDefaultsIntact )
+			{
+				// INIT
+				connection_options o;
+
+				// ACT
+				auto conn = create_connection(path.c_str(), o);
+
+				// ASSERT
+				assert_equal("delete", pragma(conn, "journal_mode"));
+				assert_equal("2", pragma(conn, "synchronous"));
+				assert_equal("0", pragma(conn, "temp_store"));
+				assert_not_null(get_statement_cache(conn));
+				assert_equal(static_cast<size_t>(default_statement_cache_capacity), get_statement_cache(conn)->capacity());
+			}
+
+
+			test( TunedOptionsAreAppliedOnOpen )
+			{
+				// INIT
+				auto o = connection_options::tuned();
+
+				o.page_size = 8192;
+				o.statement_cache_capacity = 0;
+
+				// ACT
+				auto conn = create_connection(path.c_str(), o);
+
+				// ASSERT
+				assert_equal("wal", pragma(conn, "journal_mode"));
+				assert_equal("1", pragma(conn, "synchronous"));
+				assert_equal("2", pragma(conn, "temp_store"));
+				assert_equal("268435456", pragma(conn, "mmap_size"));
+				assert_equal("-65536", pragma(conn, "cache_size"));
+				assert_equal("5000", pragma(conn, "busy_timeout"));
+				assert_equal("8192", pragma(conn, "page_size"));
+				assert_null(get_statement_cache(conn));
+			}
+
+
+			test( ConfiguredConnectionIsUsableForTransactions )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str(), connection_options::tuned());
+				auto items = plural + initialize<item>(0, "lorem") + initialize<item>(0, "ipsum");
+
+				// ACT
+				{
+					transaction t(conn);
+
+					t.create_table<item>();
+					write_all(t, items);
+					t.commit();
+				}
+
+				// ASSERT
+				transaction t(create_connection(path.c_str(), connection_options::tuned()));
+
+				assert_equivalent(items, read_all<item>(t));
+			}
+
+
+			test( ReadOnlyConnectionRejectsWrites )
+			{
+				// INIT
+				execute(create_connection(path.c_str()), "CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT NOT NULL);");
+
+				connection_options o;
+
+				o.read_only = true;
+
+				// INIT / ACT
+				auto conn = create_connection(path.c_str(), o);
+
+				// ACT / ASSERT
+				assert_throws(execute(conn, "INSERT INTO items (name) VALUES ('a')"), sql_error);
+			}
+
+
+			test( FailureToOpenThrows )
+			{
+				// INIT
+				connection_options o;
+
+				o.read_only = true;
+
+				// ACT / ASSERT
+				assert_throws(create_connection(dir.track_file("missing.db").c_str(), o), sql_error);
+			}
+
+
+			test( FailureToApplyPragmasThrows )
+			{
+				// INIT
+				connection_options o;
+
+				o.journal_mode = connection_options::journal_wal;
+				o.read_only = true;
+				execute(create_connection(path.c_str()), "CREATE TABLE items (id INTEGER PRIMARY KEY);");
+
+				// ACT / ASSERT
+				assert_throws(create_connection(path.c_str(), o), sql_error);
+			}
+
+
+			test( JournalModeThatCannotBeSetThrows )
+			{
+				// INIT
+				connection_options o;
+
+				o.journal_mode = connection_options::journal_wal;
+
+				// ACT / ASSERT
+				assert_throws(create_connection(":memory:", o), sql_error);
+			}
+
+
+			test( BusyTimeoutOfTheConnectionIsKeptByTransactions )
+			{
+				// INIT
+				connection_options o;
+
+				o.busy_timeout_ms = 1234;
+
+				auto conn = create_connection(path.c_str(), o);
+				auto plain = create_connection(path.c_str());
+
+				// ACT
+				{
+					transaction t(conn);
+					transaction t2(plain);
+
+					// ASSERT
+					assert_equal("1234", pragma(conn, "busy_timeout"));
+					assert_equal("30000", pragma(plain, "busy_timeout"));
+				}
+
+				// ACT
+				transaction t(conn, transaction::deferred, 100);
+
+				// ASSERT
+				assert_equal("100", pragma(conn, "busy_timeout"));
+			}
+
+
+			test( MultipleStatementsAreExecutedOutsideOfTransaction )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+
+				// ACT
+				execute(conn, "CREATE TABLE items (id INTEGER PRIMARY KEY, name TEXT NOT NULL);"
+					"INSERT INTO items (name) VALUES ('lorem');"
+					"INSERT INTO items (name) VALUES ('ipsum');");
+
+				// ASSERT
+				transaction t(conn);
+
+				assert_equivalent(plural + initialize<item>(1, "lorem") + initialize<item>(2, "ipsum"), read_all<item>(t));
+				assert_throws(execute(conn, "SELECT * FROM missing"), sql_error);
+			}
+		end_test_suite
+	}
+}
@@ -0,0 +1,265 @@
+#include <sql2++/database.h>
+
+#include "file_helpers.h"
+#include "helpers.h"
+
+#include <atomic>
+#include <thread>
+#include <ut/assert.h>
+#include <ut/test.h>
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		namespace
+		{
+			struct item
+			{
+				int id;
+				string name;
+
+				bool operator <(const item &rhs) const
+				{	return make_tuple(id, name) < make_tuple(rhs.id, rhs.name);	}
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, item *)
+			{
+				visitor("items");
+				visitor(identity, &item::id, "id");
+				visitor(&item::name, "name");
+			}
+		}
+
+		begin_test_suite( ConnectionPoolTests )
+			temporary_directory dir;
+			string path;
+			vector<item> items;
+
+			init( CreateSamples )
+			{
+				path = dir.track_file("sample-db.db");
+
+				transaction t(create_connection(path.c_str()));
+
+				t.create_table<item>();
+				items = plural + initialize<item>(0, "lorem") + initialize<item>(0, "ipsum");
+				write_all(t, items);
+				t.commit();
+			}
+
+
+			test( PoolOpensDatabaseInWALMode )
+			{
+				// INIT / ACT
+				connection_pool pool(path.c_str(), 2);
+
+				// ACT
+				auto m = pool.metrics();
+
+				// ASSERT
+				statement s(create_statement(*pool.write().connection(), "PRAGMA journal_mode"));
+
+				s.execute();
+				assert_equal(string("wal"), static_cast<const char *>(s.get(0)));
+				assert_equal(2u, m.readers);
+				assert_equal(0u, m.readers_in_use);
+				assert_equal(0u, m.reader_checkouts);
+			}
+
+
+			test( PoolWithoutReadersIsRejected )
+			{
+				// ACT / ASSERT
+				assert_throws(connection_pool(path.c_str(), 0), invalid_argument);
+			}
+
+
+			test( DataWrittenViaWriterIsVisibleToReaders )
+			{
+				// INIT
+				connection_pool pool(path.c_str(), 2);
+				auto i = initialize<item>(0, "dolor");
+
+				// ACT
+				{
+					transaction t(pool.write());
+
+					t.insert<item>()(i);
+					t.commit();
+				}
+
+				// ASSERT
+				transaction t(pool.read());
+
+				items.push_back(i);
+				assert_equivalent(items, read_all<item>(t));
+			}
+
+
+			test( ReadersCannotWrite )
+			{
+				// INIT
+				connection_pool pool(path.c_str(), 1);
+				transaction t(pool.read());
+				auto i = initialize<item>(0, "dolor");
+
+				// ACT / ASSERT
+				assert_throws(t.insert<item>()(i), execution_error);
+			}
+
+
+			test( ReadersSeeLastCommittedDataWhileWriteIsInProgress )
+			{
+				// INIT
+				connection_pool pool(path.c_str(), 1);
+				auto i = initialize<item>(0, "dolor");
+				transaction w(pool.write(), transaction::immediate);
+
+				w.insert<item>()(i);
+
+				// ACT
+				transaction r(pool.read());
+
+				// ASSERT
+				assert_equivalent(items, read_all<item>(r));
+			}
+
+
+			test( LeasesAreReturnedOnDestruction )
+			{
+				// INIT
+				connection_pool pool(path.c_str(), 3);
+
+				// ACT
+				auto l1 = pool.read();
+				auto l2 = pool.read();
+
+				// ASSERT
+				assert_not_equal(l1.connection(), l2.connection());
+				assert_equal(2u, pool.metrics().readers_in_use);
+
+				// ACT
+				{
+					transaction t(pool.read());
+
+					// ASSERT
+					assert_equal(3u, pool.metrics().readers_in_use);
+				}
+
+				// ASSERT
+				auto m = pool.metrics();
+
+				assert_equal(2u, m.readers_in_use);
+				assert_equal(3u, m.peak_readers_in_use);
+				assert_equal(3u, m.reader_checkouts);
+				assert_equal(0u, m.reader_waits);
+				assert_is_true(m.reader_busy_seconds >= 0.0);
+			}
+
+
+			test( StatementsCreatedUnderALeaseKeepIt )
+			{
+				// INIT
+				connection_pool pool(path.c_str(), 2);
+				item i;
+				vector<item> read;
+
+				// ACT
+				{
+					auto r = transaction(pool.read()).select<item>();
+
+					// ASSERT
+					assert_equal(1u, pool.metrics().readers_in_use);
+
+					// ACT
+					auto l = pool.read();
+
+					// ASSERT
+					assert_equal(2u, pool.metrics().readers_in_use);
+
+					// ACT
+					while (r(i))
+						read.push_back(i);
+				}
+
+				// ASSERT
+				assert_equivalent(items, read);
+				assert_equal(0u, pool.metrics().readers_in_use);
+			}
+
+
+			test( CheckoutWaitsForALeaseToBeReturned )
+			{
+				// INIT
+				connection_pool pool(path.c_str(), 1);
+				unique_ptr<connection_lease> reader(new connection_lease(pool.read()));
+				unique_ptr<connection_lease> writer(new connection_lease(pool.write()));
+				atomic<int> acquired(0);
+
+				// ACT
+				thread t1([&] {	pool.read(), acquired++;	});
+				thread t2([&] {	pool.write(), acquired++;	});
+
+				while (pool.metrics().reader_waits + pool.metrics().writer_waits < 2)
+					this_thread::yield();
+				this_thread::sleep_for(chrono::milliseconds(20));
+
+				// ASSERT
+				assert_equal(0, acquired.load());
+
+				// ACT
+				reader.reset();
+				writer.reset();
+				t1.join();
+				t2.join();
+
+				// ASSERT
+				auto m = pool.metrics();
+
+				assert_equal(2, acquired.load());
+				assert_equal(2u, m.reader_checkouts);
+				assert_equal(2u, m.writer_checkouts);
+				assert_equal(1u, m.reader_waits);
+				assert_equal(1u, m.writer_waits);
+				assert_is_true(m.reader_wait_seconds >= 0.01);
+				assert_is_true(m.writer_wait_seconds >= 0.01);
+			}
+
+
+			test( ReadersAreUsedConcurrently )
+			{
+				// INIT
+				connection_pool pool(path.c_str(), 4);
+				vector<thread> threads;
+				atomic<int> rows(0);
+
+				// ACT
+				for (int n = 8; n--; )
+				{
+					threads.push_back(thread([&] {
+						for (int k = 50; k--; )
+						{
+							transaction t(pool.read());
+
+							rows += static_cast<int>(read_all<item>(t).size());
+						}
+					}));
+				}
+				for (auto i = threads.begin(); i != threads.end(); ++i)
+					i->join();
+
+				// ASSERT
+				auto m = pool.metrics();
+
+				assert_equal(8 * 50 * 2, rows.load());
+				assert_equal(400u, m.reader_checkouts);
+				assert_equal(0u, m.readers_in_use);
+				assert_is_true(m.peak_readers_in_use <= 4u);
+			}
+		end_test_suite
+	}
+}
@@ -75,6 +75,14 @@ namespace sql2xx
 			string parent_c; // type_with_unique::c
 		};
 
+		struct type_with_indices
+		{
+			int a;
+			string b;
+			double c;
+			nullable<int> d;
+		};
+
 		struct type_with_primary
 		{
 			int a;
@@ -182,6 +190,24 @@ namespace sql2xx
 			visitor << sql2xx::unique << &type_with_primary::d;
 		}
 
+		template <typename VisitorT>
+		void describe(VisitorT &&visitor, type_with_indices *)
+		{
+			visitor(&type_with_indices::a, "a");
+			visitor(&type_with_indices::b, "b");
+			visitor(&type_with_indices::c, "c");
+			visitor(&type_with_indices::d, "d");
+
+			visitor << sql2xx::index << &type_with_indices::a;
+			visitor << sql2xx::index << &type_with_indices::b << desc(&type_with_indices::c);
+			visitor << sql2xx::unique << &type_with_indices::c;
+			visitor << sql2xx::index << &type_with_indices::c
+				<< (is_not_null(c(&type_with_indices::d)) && c(&type_with_indices::b) != lit("it's"));
+			visitor << sql2xx::index << &type_with_indices::a << (c(&type_with_indices::c) > lit(1.5));
+			visitor << sql2xx::index << &type_with_indices::a << (c(&type_with_indices::c) < lit(0.5));
+			visitor << sql2xx::index << &type_with_indices::a;
+		}
+
 		template <typename T>
 		string format_columns()
 		{
@@ -202,6 +228,15 @@ namespace sql2xx
 			sql2xx::format_create_table<T>(result, name);
 			return result;
 		}
+
+		template <typename T>
+		vector<string> format_create_indices(const char *name)
+		{
+			vector<string> result;
+
+			sql2xx::format_create_indices<T>(result, name);
+			return result;
+		}
 	}
 
 	begin_test_suite( DatabaseDDLTests )
@@ -260,5 +295,33 @@ namespace sql2xx
 				")", format_create_table<type_child_b>("Child"));
 		}
 
+
+		test( IndicesAreNotPartOfCreateTable )
+		{
+			// INIT / ACT / ASSERT
+			assert_equal("CREATE TABLE Foo ("
+				"a INTEGER NOT NULL,b TEXT NOT NULL,c REAL NOT NULL,d INTEGER,"
+				"UNIQUE(c)"
+				")", format_create_table<type_with_indices>("Foo"));
+			assert_is_empty(format_create_indices<type_with_primary>("Bar"));
+		}
+
+
+		test( FormattingCreateIndicesProvidesExpectedResults )
+		{
+			// INIT
+			string reference[] = {
+				"CREATE INDEX Foo_a_idx ON Foo(a)",
+				"CREATE INDEX Foo_b_c_desc_idx ON Foo(b,c DESC)",
+				"CREATE INDEX Foo_c_partial_idx ON Foo(c) WHERE ((d IS NOT NULL) AND (b<>'it''s'))",
+				"CREATE INDEX Foo_a_partial_idx ON Foo(a) WHERE (c>1.5)",
+				"CREATE INDEX Foo_a_partial_4_idx ON Foo(a) WHERE (c<0.5)",
+				"CREATE INDEX Foo_a_5_idx ON Foo(a)",
+			};
+
+			// ACT / ASSERT
+			assert_equal(reference, format_create_indices<type_with_indices>("Foo"));
+		}
+
 	end_test_suite
 }
@@ -2,6 +2,7 @@
 #include <sql2++/format.h>
 
 #include <cstdint>
+#include <limits>
 #include <ut/assert.h>
 #include <ut/test.h>
 
@@ -156,6 +157,17 @@ namespace sql2xx
 
 				// ASSERT
 				assert_equal("bbstaff AS t0,companies AS t1,events AS t2", result);
+
+				// INIT
+				result.clear();
+
+				// ACT
+				format_table_source(result, static_cast<tuple<event, event, event, event, event, event, event, event, event,
+					event, event, company> *>(nullptr));
+
+				// ASSERT
+				assert_equal("events AS t0,events AS t1,events AS t2,events AS t3,events AS t4,events AS t5,events AS t6,"
+					"events AS t7,events AS t8,events AS t9,events AS t10,companies AS t11", result);
 			}
 
 
@@ -218,6 +230,92 @@ namespace sql2xx
 
 				// ASSERT
 				assert_equal("At0.last_name,t0.FirstName,t0.YearOfBirth,t0.Month,t0.Day,t1.CompanyName,t1.Founded,t2.Name", result);
+
+				// INIT
+				result.clear();
+
+				// ACT
+				format_select_list(result, static_cast<tuple<event, company, event, event, event, person> *>(nullptr));
+
+				// ASSERT
+				assert_equal("t0.Name,t1.CompanyName,t1.Founded,t2.Name,t3.Name,t4.Name,t5.last_name,t5.FirstName,"
+					"t5.YearOfBirth,t5.Month,t5.Day", result);
+			}
+
+
+			test( TypeStatementsAreFormattedAccordinglyToMetadata )
+			{
+				// INIT
+				string result = "abc ";
+
+				// ACT
+				format_select<person>(result);
+
+				// ASSERT
+				assert_equal("abc SELECT last_name,FirstName,YearOfBirth,Month,Day FROM staff", result);
+
+				// INIT
+				result.clear();
+
+				// ACT
+				format_select< tuple<company, event> >(result);
+
+				// ASSERT
+				assert_equal("SELECT t0.CompanyName,t0.Founded,t1.Name FROM companies AS t0,events AS t1", result);
+
+				// INIT
+				result.clear();
+
+				// ACT
+				format_count<company>(result);
+
+				// ASSERT
+				assert_equal("SELECT COUNT(*) FROM companies", result);
+
+				// INIT
+				result.clear();
+
+				// ACT
+				format_insert<company>(result);
+
+				// ASSERT
+				assert_equal("INSERT INTO companies (CompanyName,Founded) VALUES (?,?) ", result);
+
+				// INIT
+				result.clear();
+
+				// ACT
+				format_insert<company>(result, 3);
+
+				// ASSERT
+				assert_equal("INSERT INTO companies (CompanyName,Founded) VALUES (?,?),(?,?),(?,?) ", result);
+
+				// INIT
+				result.clear();
+
+				// ACT
+				format_upsert<company>(result);
+
+				// ASSERT
+				assert_equal("INSERT INTO companies (CompanyName,Founded) VALUES (?,?)  ON CONFLICT DO UPDATE SET "
+					"CompanyName=EXCLUDED.CompanyName,Founded=EXCLUDED.Founded", result);
+			}
+
+
+			test( StaticTextIsFormattedOncePerFormatter )
+			{
+				// INIT / ACT
+				const auto &select_person = static_text< format_select<person> >();
+				const auto &select_company = static_text< format_select<company> >();
+				const auto &count_company = static_text< format_count<company> >();
+
+				// ACT / ASSERT
+				assert_equal("SELECT last_name,FirstName,YearOfBirth,Month,Day FROM staff", select_person);
+				assert_equal("SELECT CompanyName,Founded FROM companies", select_company);
+				assert_equal("SELECT COUNT(*) FROM companies", count_company);
+				assert_equal(&select_person, &static_text< format_select<person> >());
+				assert_equal(&select_company, &static_text< format_select<company> >());
+				assert_equal(&count_company, &static_text< format_count<company> >());
 			}
 
 
@@ -466,6 +564,119 @@ namespace sql2xx
 				assert_equal(" ORDER BY t0.last_name ASC,t2.FirstName DESC", format_order(c<0>(&person::last_name), true, c<2>(&person::first_name), false));
 			}
 
+
+			test( InPredicatesAreFormattedAccordinglyToBinding )
+			{
+				// INIT
+				vector<int> years;
+				string name;
+
+				// ACT / ASSERT
+				assert_equal("(YearOfBirth IN (SELECT value FROM json_each(:1)))",
+					format(in(c(&person::year), years, json_array_binding)));
+				assert_equal("(YearOfBirth IN ())", format(in(c(&person::year), years, parameter_list_binding)));
+
+				// INIT
+				years.push_back(1);
+
+				// ACT / ASSERT
+				assert_equal("(YearOfBirth IN (:1))", format(in(c(&person::year), years, parameter_list_binding)));
+
+				// INIT
+				years.push_back(2), years.push_back(3);
+
+				// ACT / ASSERT
+				assert_equal("((last_name=:1) AND (YearOfBirth IN (:2,:3,:4,:5)))",
+					format(c(&person::last_name) == p(name) && in(c(&person::year), years, parameter_list_binding)));
+				assert_equal("((YearOfBirth IN (SELECT value FROM json_each(:1))) AND (last_name=:2))",
+					format(in(c(&person::year), years, json_array_binding) && c(&person::last_name) == p(name)));
+			}
+
+
+			test( ValuesAreFormattedAsJSONArrays )
+			{
+				// INIT
+				vector<int> ints;
+				vector<string> strings;
+				string result;
+
+				ints.push_back(-1), ints.push_back(0), ints.push_back(314);
+				strings.push_back("a\"b\\c\n"), strings.push_back("");
+
+				// ACT / ASSERT
+				assert_equal("[-1,0,314]", (format_json_array(result, ints), result));
+				result.clear();
+				assert_equal("[\"a\\\"b\\\\c\\u000a\",\"\"]", (format_json_array(result, strings), result));
+				result.clear();
+				assert_equal("[]", (format_json_array(result, vector<double>()), result));
+			}
+
+
+			test( FloatingPointValuesAreFormattedAsJSONNumbersAtFullPrecision )
+			{
+				// INIT
+				vector<float> floats;
+				vector<double> doubles;
+				string result;
+
+				floats.push_back(0.1f), floats.push_back(-2.5f);
+				doubles.push_back(0.1), doubles.push_back(numeric_limits<double>::infinity());
+				doubles.push_back(-numeric_limits<double>::infinity()), doubles.push_back(numeric_limits<double>::quiet_NaN());
+
+				// ACT / ASSERT
+				assert_equal("[0.10000000149011612,-2.5]", (format_json_array(result, floats), result));
+				result.clear();
+				assert_equal("[0.10000000000000001,9e999,-9e999,null]", (format_json_array(result, doubles), result));
+			}
+
+
+			test( AggregatesAreFormattedAsFunctions )
+			{
+				// INIT
+				int year = 0;
+
+				// ACT / ASSERT
+				assert_equal("SUM(YearOfBirth)", format(sum(c(&person::year))));
+				assert_equal("MIN(last_name)", format(min(c(&person::last_name))));
+				assert_equal("MAX(t1.FirstName)", format(max(c<1>(&person::first_name))));
+				assert_equal("AVG(Month)", format(avg(c(&person::month))));
+				assert_equal("COUNT(Day)", format(count(c(&person::day))));
+				assert_equal("COUNT(*)", format(count()));
+				assert_equal("GROUP_CONCAT(last_name)", format(group_concat(c(&person::last_name))));
+				assert_equal("GROUP_CONCAT(last_name,'; ')", format(group_concat(c(&person::last_name), "; ")));
+				assert_equal("(SUM(YearOfBirth)>:1)", format(sum(c(&person::year)) > p(year)));
+			}
+
+
+			test( LimitAndOffsetAreFormattedAsNamedParametersAfterOrder )
+			{
+				// INIT / ACT / ASSERT
+				assert_equal(" LIMIT :limit", format_order(limit(10)));
+				assert_equal(" LIMIT -1 OFFSET :offset", format_order(offset(10)));
+				assert_equal(" LIMIT :limit OFFSET :offset", format_order(limit(10), offset(20)));
+				assert_equal(" ORDER BY FirstName ASC LIMIT :limit", format_order(c(&person::first_name), true, limit(3)));
+				assert_equal(" ORDER BY last_name ASC,FirstName DESC LIMIT :limit OFFSET :offset",
+					format_order(c(&person::last_name), true, c(&person::first_name), false, limit(3), offset(1)));
+			}
+
+
+			test( RowValuesAreFormattedAsLists )
+			{
+				// INIT
+				int year = 1;
+				string name;
+				person last = {	"John", "Doe", 1980	};
+
+				// ACT / ASSERT
+				assert_equal("((YearOfBirth,last_name)>(:1,:2))",
+					format(row(c(&person::year), c(&person::last_name)) > row(p(year), p(name))));
+				assert_equal("(((YearOfBirth,last_name)<(:1,:2)) AND (FirstName=:3))",
+					format(row(c(&person::year), c(&person::last_name)) < row(p(year), p(name))
+						&& c(&person::first_name) == p(name)));
+				assert_equal("((last_name,YearOfBirth)>(:1,:2))", format(seek_after(last, &person::last_name, &person::year)));
+				assert_equal("((YearOfBirth)<(:1))", format(seek_before(last, &person::year)));
+			}
+
 		end_test_suite
 	}
 }
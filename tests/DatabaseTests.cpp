@@ -1,5 +1,6 @@
 #include <sql2++/database.h>
 
+#include "allocation_helpers.h"
 #include "file_helpers.h"
 #include "helpers.h"
 
@@ -176,6 +177,26 @@ namespace sql2xx
 				}
 			};
 
+			struct sample_unique_identified
+			{
+				int id;
+				string username;
+				string email;
+				int age;
+			};
+
+			struct sample_item_64
+			{
+				int64_t id;
+				int a;
+				string b;
+			};
+
+			struct identity_only
+			{
+				int id;
+			};
+
 			template <typename VisitorT>
 			void describe(VisitorT &visitor, test_a<0> *)
 			{
@@ -274,6 +295,32 @@ namespace sql2xx
 				visitor(&sample_unique::age, "age");
 				visitor(&sample_unique::created_at, "created_at");
 			}
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, sample_unique_identified *)
+			{
+				visitor("sample_unique");
+				visitor(identity, &sample_unique_identified::id, "rowid");
+				visitor(&sample_unique_identified::username, "username");
+				visitor(&sample_unique_identified::email, "email");
+				visitor(&sample_unique_identified::age, "age");
+			}
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, sample_item_64 *)
+			{
+				visitor("sample_items_3");
+				visitor(identity, &sample_item_64::id, "MyID");
+				visitor(&sample_item_64::a, "a");
+				visitor(&sample_item_64::b, "b");
+			}
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, identity_only *)
+			{
+				visitor("identity_only");
+				visitor(identity, &identity_only::id, "id");
+			}
 		}
 
 		begin_test_suite( DatabaseTests )
@@ -596,6 +643,431 @@ namespace sql2xx
 			}
 
 
+			test( InserterRemainsUsableAfterAFailedInsertion )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				auto w = t.insert<sample_unique>();
+				auto duplicate = make_shared<sample_unique>(
+					initialize<sample_unique>("Bob", "bob@example.com", 1, nullable<string>("a rather long text value")));
+				auto item = initialize<sample_unique>("zoe", "zoe@example.com", 19, nullable<string>());
+
+				// ACT / ASSERT
+				assert_throws(w(*duplicate), execution_error);
+
+				// INIT
+				duplicate.reset();
+
+				// ACT
+				w(item);
+
+				// ASSERT
+				assert_equal(1u, t.count<sample_unique>(c(&sample_unique::username) == p<const string>("zoe")
+					&& is_null(c(&sample_unique::created_at))));
+			}
+
+
+			test( RangesOfRecordsAreInsertedInBatchesAndIdentitiesAreSet )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				vector< sample_item_3<0> > items, reference;
+
+				for (auto n = 0; n != 150; ++n)
+				{
+					sample_item_3<0> item = {	0, n, "item #" + to_string(n), 10000000000ll + n, 0.5 * n, 0u + n, 3u * n	};
+
+					items.push_back(item);
+					item.id = n + 1;
+					reference.push_back(item);
+				}
+
+				auto w = t.insert< sample_item_3<0> >();
+
+				// ACT
+				w(items.begin(), items.end());
+
+				// ASSERT
+				assert_equal(reference.size(), items.size());
+				for (auto i = 0u; i != items.size(); ++i)
+					assert_equal(reference[i].id, items[i].id);
+				assert_equivalent(reference, read_all< sample_item_3<0> >(t));
+
+				// INIT
+				items.resize(2);
+
+				// ACT
+				w(items.begin(), items.begin());
+				w(items.begin(), items.begin() + 1);
+				w(items.begin() + 1, items.end());
+
+				// ASSERT
+				assert_equal(151, items[0].id);
+				assert_equal(152, items[1].id);
+				assert_equal(152u, t.count< sample_item_3<0> >());
+			}
+
+
+			test( RecordsTooWideForTwoRowsPerStatementAreInsertedOneByOne )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+
+				sqlite3_limit(conn.get(), SQLITE_LIMIT_VARIABLE_NUMBER, 6);
+
+				transaction t(conn);
+				vector< sample_item_3<0> > items;
+
+				for (auto n = 0; n != 5; ++n)
+				{
+					sample_item_3<0> item = {	0, n, "item #" + to_string(n), 10000000000ll + n, 0.5 * n, 0u + n, 3u * n	};
+
+					items.push_back(item);
+				}
+
+				auto w = t.insert< sample_item_3<0> >();
+
+				// ACT
+				w(items.begin(), items.end());
+
+				// ASSERT
+				for (auto i = 0u; i != items.size(); ++i)
+					assert_equal(static_cast<int>(i + 1), items[i].id);
+				assert_equivalent(items, read_all< sample_item_3<0> >(t));
+			}
+
+
+			test( RecordsAreInsertedOneByOneOnceRowidsReachTheMaximum )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				transaction t(conn);
+				vector<sample_item_64> items;
+
+				statement(create_statement(conn,
+					"INSERT INTO sample_items_3 (MyID, a) VALUES (9223372036854775805, -1)")).execute();
+				for (auto n = 0; n != 10; ++n)
+				{
+					sample_item_64 item = {	0, n, "item #" + to_string(n)	};
+
+					items.push_back(item);
+				}
+
+				auto w = t.insert<sample_item_64>();
+
+				// ACT
+				w(items.begin(), items.end());
+
+				// ASSERT
+				for (auto i = items.begin(); i != items.end(); ++i)
+				{
+					sample_item_64 stored;
+					auto r = t.select<sample_item_64>(c(&sample_item_64::id) == p<const int64_t>(i->id));
+
+					assert_is_true(r(stored));
+					assert_equal(i->a, stored.a);
+					assert_equal(i->b, stored.b);
+				}
+				assert_equal(11u, t.count<sample_item_64>());
+			}
+
+
+			test( RecordsWithoutIdentityAndNullsAreInsertedInBatches )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				auto items1 = plural
+					+ initialize<sample_item_1>(1, "test")
+					+ initialize<sample_item_1>(2, "testtest")
+					+ initialize<sample_item_1>(3, "sample");
+				auto items2 = plural
+					+ initialize< test_a<0> >("Bob Marley", 42, nullable<string>(), nullable<int>(5612), nullable<double>())
+					+ initialize< test_a<0> >("Charlie Chaplin", 71, nullable<string>("Holywood"), nullable<int>(), nullable<double>(3.141555));
+				auto w1 = t.insert<sample_item_1>();
+				auto w2 = t.insert< test_a<0> >();
+
+				// ACT
+				w1(items1.begin(), items1.end());
+				w2(items2.begin(), items2.end());
+
+				// ASSERT
+				assert_equivalent(items1, read_all<sample_item_1>(t));
+				assert_equal(6u, t.count< test_a<0> >());
+				assert_equal(1u, t.count< test_a<0> >(c(&test_a<0>::employer) == p<const string>("Holywood")));
+				assert_equal(1u, t.count< test_a<0> >(c(&test_a<0>::foo) == p<const int>(5612)));
+			}
+
+
+			test( RangesOfRecordsAreUpsertedInBatches )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				auto items = plural
+					+ initialize<sample_unique>("dave", "dave@example.com", 40, nullable<string>("2024-06-04"))
+					+ initialize<sample_unique>("alice", "alice@example.com", 31, nullable<string>());
+				auto w = t.upsert<sample_unique>();
+
+				// ACT
+				w(items.begin(), items.end());
+
+				// ASSERT
+				assert_equivalent(plural
+					+ initialize<sample_unique>("alice", "alice@example.com", 31, nullable<string>())
+					+ initialize<sample_unique>("Bob", "bob@example.com", 25, nullable<string>("2024-06-02"))
+					+ initialize<sample_unique>("carol", "carol@example.com", 28, nullable<string>("2024-06-03"))
+					+ initialize<sample_unique>("dave", "dave@example.com", 40, nullable<string>("2024-06-04")),
+					read_all<sample_unique>(t));
+			}
+
+
+			test( UpsertedRangesReceiveIdentitiesOfTheRowsTheyLandedIn )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				auto items = plural
+					+ initialize<sample_unique_identified>(0, "dave", "dave@example.com", 40)
+					+ initialize<sample_unique_identified>(0, "alice", "alice@example.com", 31)
+					+ initialize<sample_unique_identified>(0, "erin", "erin@example.com", 22);
+				auto w = t.upsert<sample_unique_identified>();
+
+				// ACT
+				w(items.begin(), items.end());
+
+				// ASSERT
+				assert_equal(4, items[0].id);
+				assert_equal(1, items[1].id);
+				assert_equal(5, items[2].id);
+
+				// INIT
+				auto single = initialize<sample_unique_identified>(0, "carol", "carol@example.com", 29);
+
+				// ACT
+				w(single);
+
+				// ASSERT
+				sample_unique_identified stored = {	};
+				auto r = t.select<sample_unique_identified>(c(&sample_unique_identified::id) == p<const int>(3));
+
+				assert_equal(3, single.id);
+				assert_is_true(r(stored));
+				assert_equal("carol", stored.username);
+				assert_equal(29, stored.age);
+			}
+
+
+			test( RangesOfRecordsAreUpdatedByIdentity )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				vector< sample_item_3<0> > items;
+
+				for (auto n = 0; n != 150; ++n)
+				{
+					sample_item_3<0> item = {	0, n, "item #" + to_string(n), 10000000000ll + n, 0.5 * n, 0u + n, 3u * n	};
+
+					items.push_back(item);
+				}
+				t.insert< sample_item_3<0> >()(items.begin(), items.end());
+				for (auto i = items.begin(); i != items.end(); ++i)
+					i->a *= 7, i->b += " (modified)", i->d = -i->d;
+
+				// ACT
+				auto changed = t.update_records< sample_item_3<0> >(items);
+
+				// ASSERT
+				assert_equal(150u, changed);
+				assert_equivalent(items, read_all< sample_item_3<0> >(t));
+
+				// INIT
+				auto reference = items;
+
+				items.resize(3);
+				items[0].c = 1, items[1].c = 2, items[2].c = 3;
+				items[2].id = 1000;
+				reference[0].c = 1, reference[1].c = 2;
+
+				// ACT
+				changed = t.update_records< sample_item_3<0> >(items.begin(), items.end());
+
+				// ASSERT
+				assert_equal(2u, changed);
+				assert_equivalent(reference, read_all< sample_item_3<0> >(t));
+			}
+
+
+			test( UpdatingRecordsWithoutIdentityIsRejected )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				auto items = plural
+					+ initialize<sample_item_1>(1, "test");
+
+				// ACT / ASSERT
+				assert_throws(t.update_records<sample_item_1>(items), sql_error);
+				assert_throws(t.update_records<identity_only>(vector<identity_only>(1)), sql_error);
+				assert_equal(0u, t.update_records< sample_item_3<0> >(vector< sample_item_3<0> >()));
+			}
+
+
+			test( RangesOfRecordsAreRemovedByIdentity )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				vector< sample_item_3<0> > items;
+
+				for (auto n = 0; n != 10; ++n)
+				{
+					sample_item_3<0> item = {	0, n, "item #" + to_string(n), 0, 0.0, 0u, 0u	};
+
+					items.push_back(item);
+				}
+				t.insert< sample_item_3<0> >()(items.begin(), items.end());
+
+				auto removed_items = plural + items[1] + items[4] + items[7];
+				auto reference = plural + items[0] + items[2] + items[3] + items[5] + items[6] + items[8] + items[9];
+
+				removed_items[2].id = 1000;
+				reference.push_back(items[7]);
+
+				// ACT
+				auto changed = t.remove_records< sample_item_3<0> >(removed_items);
+
+				// ASSERT
+				assert_equal(2u, changed);
+				assert_equivalent(reference, read_all< sample_item_3<0> >(t));
+
+				// ACT / ASSERT
+				assert_throws(t.remove_records<sample_item_1>(plural + initialize<sample_item_1>(1, "test")), sql_error);
+				assert_equal(0u, t.remove_records< sample_item_3<0> >(vector< sample_item_3<0> >()));
+			}
+
+
+			test( TextWithEmbeddedZerosIsWrittenAndRead )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				auto items = plural
+					+ initialize<sample_unique>(string("al\0ice", 6), string("a\0b\0c", 5), 1, nullable<string>(string("\0", 1)))
+					+ initialize<sample_unique>(string("\0", 1), "", 2, nullable<string>(string("x\0", 2)));
+
+				t.remove<sample_unique>(p<const int>(1) == p<const int>(1)).execute();
+
+				// ACT
+				write_all(t, items);
+
+				// ASSERT
+				auto read = read_all<sample_unique>(t);
+
+				assert_equivalent(items, read);
+				assert_equal(6u, read[0].username.size());
+				assert_equal(5u, read[0].email.size());
+				assert_equal(1u, (*read[0].created_at).size());
+			}
+
+
+			test( ReadingIntoTheSameRecordReusesStringCapacity )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				transaction t(conn);
+				const string long_text(200, 'x');
+				auto items = plural
+					+ initialize<sample_unique>(long_text + "1", long_text + "2", 1, nullable<string>(long_text + "3"))
+					+ initialize<sample_unique>(long_text + "45", long_text + "6", 2, nullable<string>(long_text + "78"));
+				sample_unique item;
+
+				t.remove<sample_unique>(p<const int>(1) == p<const int>(1)).execute();
+				write_all(t, items);
+				for (auto r = t.select<sample_unique>(); r(item); )
+				{	}
+
+				// ACT
+				allocation_counter counter;
+
+				for (auto n = 10; n--; )
+				{
+					auto r = t.select<sample_unique>();
+
+					while (r(item))
+					{	}
+				}
+
+				// ASSERT
+				assert_equal(0u, counter.allocations());
+				assert_equal(long_text + "78", *item.created_at);
+			}
+
+
+			test( RecordsCanBeIteratedOver )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				auto r = t.select<sample_unique>(c(&sample_unique::age) > p<const int>(25), c(&sample_unique::age), true);
+				vector<string> names;
+
+				// ACT
+				for (const auto &item : r)
+					names.push_back(item.username);
+
+				// ASSERT
+				assert_equal(plural + string("carol") + string("alice"), names);
+
+				// INIT
+				auto r2 = t.select<sample_unique>();
+
+				// ACT
+				auto i = find_if(r2.begin(), r2.end(), [] (const sample_unique &item) {	return item.age == 25;	});
+
+				// ASSERT
+				assert_is_true(r2.end() != i);
+				assert_equal("bob@example.com", i->email);
+				assert_is_true(r2.end() != ++i);
+				assert_equal("carol", (*i++).username);
+				assert_is_true(r2.end() == i);
+			}
+
+
+			test( RecordsAreReadInChunksReusingElements )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				transaction t(conn);
+				const string long_text(200, 'x');
+				vector< sample_item_3<0> > items, chunk, read;
+
+				for (auto n = 0; n != 25; ++n)
+				{
+					sample_item_3<0> item = {	0, n, long_text + to_string(100 + n), 0, 0.0, 0u, 0u	};
+
+					items.push_back(item);
+				}
+				t.insert< sample_item_3<0> >()(items.begin(), items.end());
+
+				auto r = t.select< sample_item_3<0> >();
+
+				// ACT / ASSERT
+				assert_equal(10u, r.read_chunk(chunk, 10));
+				assert_equal(10u, chunk.size());
+				read.insert(read.end(), chunk.begin(), chunk.end());
+
+				// ACT
+				allocation_counter counter;
+				auto n = r.read_chunk(chunk, 10);
+				const auto allocations = counter.allocations();
+
+				// ASSERT
+				assert_equal(10u, n);
+				assert_equal(0u, allocations);
+				read.insert(read.end(), chunk.begin(), chunk.end());
+
+				// ACT / ASSERT
+				assert_equal(5u, r.read_chunk(chunk, 10));
+				assert_equal(5u, chunk.size());
+				read.insert(read.end(), chunk.begin(), chunk.end());
+				assert_equivalent(items, read);
+			}
+
+
 			test( AllSupportedTypesCanBeSelected )
 			{
 				// INIT
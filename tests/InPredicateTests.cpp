@@ -0,0 +1,420 @@
+#include <sql2++/database.h>
+
+#include "file_helpers.h"
+#include "helpers.h"
+
+#include <algorithm>
+#include <limits>
+#include <sqlite3.h>
+#include <ut/assert.h>
+#include <ut/test.h>
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		namespace
+		{
+			struct item
+			{
+				int id;
+				string name;
+				int group;
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, item *)
+			{
+				visitor("items");
+				visitor(identity, &item::id, "id");
+				visitor(&item::name, "name");
+				visitor(&item::group, "group_");
+			}
+
+			struct reading
+			{
+				int id;
+				double value;
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, reading *)
+			{
+				visitor("readings");
+				visitor(identity, &reading::id, "id");
+				visitor(&reading::value, "value");
+			}
+
+			vector<int> read_ids(reader<item> &&r)
+			{
+				vector<int> ids;
+
+				for (item i; r(i); )
+					ids.push_back(i.id);
+				return ids;
+			}
+		}
+
+		begin_test_suite( InPredicateTests )
+			temporary_directory dir;
+			string path;
+
+			init( CreateSamples )
+			{
+				path = dir.track_file("sample-db.db");
+
+				transaction t(create_connection(path.c_str()));
+
+				t.create_table<item>();
+
+				auto ins = t.insert<item>();
+
+				for (auto n = 0; n != 10000; ++n)
+				{
+					item i = {	0, "item #" + to_string(n), n % 7	};
+
+					ins(i);
+				}
+
+				item quoted = {	0, "\"quoted\", 'apostrophes' \\ and\nnewline", -1	};
+
+				ins(quoted);
+				t.commit();
+			}
+
+
+			test( RecordsAreSelectedByAJSONArrayOfKeys )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				vector<int> ids;
+
+				for (auto id = 3; id <= 10000; id += 2)
+					ids.push_back(id);
+
+				// ACT
+				auto r = read_ids(t.select<item>(in(c(&item::id), ids, json_array_binding), c(&item::id), true));
+
+				// ASSERT
+				assert_equal(ids, r);
+			}
+
+
+			test( RecordsAreSelectedByAParameterList )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				vector<int> ids;
+
+				ids.push_back(7), ids.push_back(1), ids.push_back(9999), ids.push_back(20000);
+				ids.push_back(5), ids.push_back(9);
+
+				// ACT
+				auto r = read_ids(t.select<item>(in(c(&item::id), ids, parameter_list_binding), c(&item::id), true));
+
+				// ASSERT
+				int reference[] = {	1, 5, 7, 9, 9999,	};
+
+				assert_equal(reference, r);
+			}
+
+
+			test( TextValuesAreMatchedExactly )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				vector<string> names;
+
+				names.push_back("item #17");
+				names.push_back("\"quoted\", 'apostrophes' \\ and\nnewline");
+				names.push_back("item #");
+
+				// ACT / ASSERT
+				int reference[] = {	18, 10001,	};
+
+				assert_equal(reference, read_ids(t.select<item>(in(c(&item::name), names, json_array_binding), c(&item::id), true)));
+				assert_equal(reference, read_ids(t.select<item>(in(c(&item::name), names, parameter_list_binding), c(&item::id), true)));
+			}
+
+
+			test( EmptyContainersMatchNothing )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				vector<int> ids;
+
+				// ACT / ASSERT
+				assert_is_empty(read_ids(t.select<item>(in(c(&item::id), ids, json_array_binding))));
+				assert_is_empty(read_ids(t.select<item>(in(c(&item::id), ids, parameter_list_binding))));
+				assert_equal(0u, t.count<item>(in(c(&item::id), ids)));
+			}
+
+
+			test( InPredicatesComposeWithOtherConditionsAndModifications )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				vector<int> ids, groups;
+				int group = 3, new_group = 100;
+
+				for (auto id = 1; id <= 70; ++id)
+					ids.push_back(id);
+				groups.push_back(1), groups.push_back(2);
+
+				// ACT
+				t.update<item>(in(c(&item::id), ids) && c(&item::group) == p(group), &item::group, new_group).execute();
+				t.remove<item>(in(c(&item::id), ids) && in(c(&item::group), groups)).execute();
+
+				// ASSERT
+				assert_equal(10u, t.count<item>(c(&item::group) == p(new_group)));
+				assert_equal(10001u - 20u, t.count<item>());
+			}
+
+
+			test( ParameterListsLongerThanTheVariableLimitAreExecutedInChunks )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				transaction t(conn);
+				const auto limit = sqlite3_limit(conn.get(), SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+				vector<int> ids, reference;
+
+				for (auto id = 1; id <= 100; ++id)
+					ids.push_back(id); // Duplicates of the values in the last chunk.
+				for (auto id = limit + 1; id; --id)
+					ids.push_back(id);
+				for (auto id = 1; id <= 10001; ++id)
+					reference.push_back(id);
+
+				// ACT
+				auto r = read_ids(t.select<item>(in(c(&item::id), ids, parameter_list_binding)));
+
+				// ASSERT
+				sort(r.begin(), r.end());
+				assert_equal(reference, r);
+				assert_equal(10001u, t.count<item>(in(c(&item::id), ids, parameter_list_binding)));
+				assert_equal(1429u, t.count<item>(in(c(&item::id), ids, parameter_list_binding)
+					&& c(&item::group) == lit(3)));
+
+				// INIT
+				int group = 3, new_group = 100;
+				auto u = t.update<item>(in(c(&item::id), ids, parameter_list_binding) && c(&item::group) == p(group),
+					&item::group, new_group);
+
+				// ACT / ASSERT
+				assert_equal(1429, u.execute());
+				assert_equal(0, t.remove<item>(c(&item::group) == p(group)
+					&& in(c(&item::id), ids, parameter_list_binding)).execute());
+				assert_equal(1429, t.remove<item>(c(&item::group) == p(new_group)
+					&& in(c(&item::id), ids, parameter_list_binding)).execute());
+				assert_equal(10001u - 1429u, t.count<item>());
+			}
+
+
+			test( ParameterListsExecutedInChunksCanOnlyBeAndedWithTheRestOfTheCondition )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				transaction t(conn);
+				vector<int> ids;
+				int group = 3;
+
+				for (auto id = sqlite3_limit(conn.get(), SQLITE_LIMIT_VARIABLE_NUMBER, -1) + 1; id; --id)
+					ids.push_back(id);
+
+				// ACT / ASSERT
+				assert_throws(t.count<item>(in(c(&item::id), ids, parameter_list_binding) || c(&item::group) == p(group)),
+					sql_error);
+				assert_throws(t.count<item>(c(&item::group) == p(group) || in(c(&item::id), ids, parameter_list_binding)),
+					sql_error);
+				assert_throws(t.select<item>(in(c(&item::id), ids, parameter_list_binding), c(&item::id), true),
+					sql_error);
+				assert_throws(t.select(c(&item::name)).where(in(c(&item::id), ids, parameter_list_binding)), sql_error);
+				assert_equal(10001u, t.count<item>(in(c(&item::id), ids, parameter_list_binding)));
+			}
+
+
+			test( ParameterListsExecutedInChunksCannotFilterOnAFieldBeingUpdated )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				transaction t(conn);
+				vector<int> groups, few_groups;
+				int new_group = 3;
+				string name = "renamed";
+
+				for (auto group = sqlite3_limit(conn.get(), SQLITE_LIMIT_VARIABLE_NUMBER, -1) + 1; group; --group)
+					groups.push_back(group);
+				few_groups.push_back(1), few_groups.push_back(2);
+
+				// ACT / ASSERT
+				assert_throws(t.update<item>(in(c(&item::group), groups, parameter_list_binding), &item::group, new_group),
+					sql_error);
+				assert_throws(t.update<item>(c(&item::id) > lit(0) && in(c(&item::group), groups, parameter_list_binding),
+					&item::name, name, &item::group, new_group), sql_error);
+				assert_throws(t.update_returning<item>(in(c(&item::group), groups, parameter_list_binding),
+					&item::group, new_group), sql_error);
+				assert_equal(0u, t.count<item>(c(&item::name) == p(name)));
+
+				// ACT / ASSERT (the field filtered on is not updated, or the list is not chunked)
+				assert_equal(8571, t.update<item>(in(c(&item::group), groups, parameter_list_binding), &item::name,
+					name).execute());
+				assert_equal(2858, t.update<item>(in(c(&item::group), few_groups, parameter_list_binding), &item::group,
+					new_group).execute());
+				assert_equal(0u, t.count<item>(in(c(&item::group), few_groups)));
+			}
+
+
+			test( ValuesAddedAfterFormattingAreBoundInChunksOfTheListFormatted )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				vector<int> ids;
+
+				ids.push_back(1), ids.push_back(2), ids.push_back(3);
+
+				const auto in_ids = in(c(&item::id), ids, parameter_list_binding);
+				auto removal = t.remove<item>(in(c(&item::id), ids, parameter_list_binding));
+
+				for (auto id = 4; id <= 20; ++id)
+					ids.push_back(id);
+
+				// ACT
+				auto r = read_ids(t.select<item>(in_ids));
+
+				// ASSERT
+				sort(r.begin(), r.end());
+				assert_equal(ids, r);
+				assert_equal(20u, t.count<item>(in_ids));
+
+				// ACT
+				removal.reset();
+
+				// ACT / ASSERT
+				assert_equal(20, removal.execute());
+				assert_equal(10001u - 20u, t.count<item>());
+			}
+
+
+			test( ParameterListsCannotBecomeEmptyOrStopBeingEmptyOnceFormatted )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				vector<int> none, some(1, 5);
+				auto removal1 = t.remove<item>(in(c(&item::id), none, parameter_list_binding));
+				auto removal2 = t.remove<item>(in(c(&item::id), some, parameter_list_binding));
+
+				none.push_back(1);
+				some.clear();
+
+				// ACT / ASSERT
+				assert_throws(removal1.reset(), sql_error);
+				assert_throws(removal2.reset(), sql_error);
+				assert_equal(10001u, t.count<item>());
+			}
+
+
+			test( SeveralParameterListsOfAStatementAreBoundInAllCombinationsOfTheirChunks )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				vector<int> ids, groups;
+
+				ids.push_back(1), ids.push_back(2), ids.push_back(3);
+				groups.push_back(1000), groups.push_back(3), groups.push_back(1001);
+
+				const auto where = in(c(&item::id), ids, parameter_list_binding)
+					&& in(c(&item::group), groups, parameter_list_binding);
+
+				for (auto id = 4; id <= 20; ++id)
+					ids.push_back(id);
+				for (auto group = 1002; group != 1012; ++group)
+					groups.push_back(group);
+
+				// ACT
+				auto r = read_ids(t.select<item>(where));
+
+				// ASSERT
+				int reference[] = {	4, 11, 18,	};
+
+				sort(r.begin(), r.end());
+				assert_equal(reference, r);
+				assert_equal(3u, t.count<item>(where));
+			}
+
+
+			test( SelectionByKeysUsesThePrimaryKey )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				vector<int> ids(3, 1);
+
+				// ACT
+				auto plan = t.explain_select<item>(in(c(&item::id), ids, json_array_binding));
+
+				// ASSERT
+				assert_equal("SEARCH items USING INTEGER PRIMARY KEY (rowid=?)", plan[0].detail);
+			}
+
+
+			test( StatementsAreReusedForParameterListsOfTheSameBucket )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				transaction t(conn);
+				vector<int> ids;
+				auto cache = get_statement_cache(conn);
+
+				ids.push_back(1), ids.push_back(2), ids.push_back(3);
+				read_ids(t.select<item>(in(c(&item::id), ids, parameter_list_binding), c(&item::id), true));
+
+				const auto misses = cache->misses();
+
+				// ACT
+				ids.push_back(4);
+				auto r = read_ids(t.select<item>(in(c(&item::id), ids, parameter_list_binding), c(&item::id), true));
+
+				// ASSERT
+				int reference[] = {	1, 2, 3, 4,	};
+
+				assert_equal(reference, r);
+				assert_equal(misses, cache->misses());
+
+				// ACT
+				ids.push_back(5);
+				read_ids(t.select<item>(in(c(&item::id), ids, parameter_list_binding), c(&item::id), true));
+
+				// ASSERT
+				assert_equal(misses + 1, cache->misses());
+			}
+
+
+			test( FloatingPointValuesAreMatchedExactly )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				reading readings[] = {
+					{	0, 0.1f	}, {	0, 0.1	}, {	0, numeric_limits<double>::infinity()	}, {	0, 7.0	},
+				};
+				vector<float> floats;
+				vector<double> doubles;
+
+				t.create_table<reading>();
+				t.insert<reading>()(begin(readings), end(readings));
+				floats.push_back(0.1f), floats.push_back(7.0f);
+				doubles.push_back(numeric_limits<double>::infinity()), doubles.push_back(numeric_limits<double>::quiet_NaN());
+				doubles.push_back(0.1);
+
+				// ACT / ASSERT
+				assert_equal(2u, t.count<reading>(in(c(&reading::value), floats, json_array_binding)));
+				assert_equal(2u, t.count<reading>(in(c(&reading::value), floats, parameter_list_binding)));
+				assert_equal(2u, t.count<reading>(in(c(&reading::value), floats, json_array_binding)
+					&& (c(&reading::id) == lit(1) || c(&reading::id) == lit(4))));
+				assert_equal(2u, t.count<reading>(in(c(&reading::value), doubles, json_array_binding)));
+				assert_equal(2u, t.count<reading>(in(c(&reading::value), doubles, parameter_list_binding)));
+			}
+		end_test_suite
+	}
+}
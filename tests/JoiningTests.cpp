@@ -61,6 +61,23 @@ namespace sql2xx
 				{	return make_tuple(movie_id, actor_id, name) < make_tuple(rhs.movie_id, rhs.actor_id, rhs.name);	}
 			};
 
+			struct studio
+			{
+				int id;
+				string name;
+
+				bool operator <(const studio &rhs) const
+				{	return make_tuple(id, name) < make_tuple(rhs.id, rhs.name);	}
+			};
+
+			struct production
+			{
+				int movie_id, studio_id;
+
+				bool operator <(const production &rhs) const
+				{	return make_tuple(movie_id, studio_id) < make_tuple(rhs.movie_id, rhs.studio_id);	}
+			};
+
 
 
 			template <typename V>
@@ -89,6 +106,22 @@ namespace sql2xx
 				visitor(&character::actor_id, "actor_id");
 				visitor(&character::name, "name");
 			}
+
+			template <typename V>
+			void describe(V& visitor, studio *)
+			{
+				visitor("studios");
+				visitor(identity, &studio::id, "id");
+				visitor(&studio::name, "name");
+			}
+
+			template <typename V>
+			void describe(V& visitor, production *)
+			{
+				visitor("productions");
+				visitor(&production::movie_id, "movie_id");
+				visitor(&production::studio_id, "studio_id");
+			}
 		}
 
 		begin_test_suite( JoiningTests )
@@ -98,6 +131,8 @@ namespace sql2xx
 			vector<movie> movies;
 			vector<actor> actors;
 			vector<character> characters;
+			vector<studio> studios;
+			vector<production> productions;
 
 			init( Init )
 			{
@@ -106,6 +141,8 @@ namespace sql2xx
 				tx->create_table<movie>();
 				tx->create_table<actor>();
 				tx->create_table<character>();
+				tx->create_table<studio>();
+				tx->create_table<production>();
 
 				movies = plural
 					+ movie::make(0, "Heat", 1995)
@@ -129,6 +166,15 @@ namespace sql2xx
 					+ character::make(movies[2].id, actors[2].id, "Maverick")
 					+ character::make(movies[2].id, actors[3].id, "Ice");
 				write_all(*tx, characters);
+
+				studios = plural + initialize<studio>(0, "Warner Bros.") + initialize<studio>(0, "Paramount");
+				write_all(*tx, studios);
+
+				productions = plural
+					+ initialize<production>(movies[0].id, studios[0].id)
+					+ initialize<production>(movies[1].id, studios[1].id)
+					+ initialize<production>(movies[2].id, studios[1].id);
+				write_all(*tx, productions);
 			}
 
 
@@ -218,6 +264,29 @@ namespace sql2xx
 					+ make_tuple(actors[0], movies[0], characters[0])
 					+ make_tuple(actors[0], movies[1], characters[3]), AlPacinoMovies);
 			}
+
+			test( ManyTablesCanBeJoined )
+			{
+				// INIT / ACT
+				auto paramountCast = read_all(tx->select< tuple<actor, character, movie, production, studio> >(
+					c<0>(&actor::id) == c<1>(&character::actor_id) && c<2>(&movie::id) == c<1>(&character::movie_id)
+						&& c<3>(&production::movie_id) == c<2>(&movie::id) && c<4>(&studio::id) == c<3>(&production::studio_id)
+						&& c<4>(&studio::name) == p<const string>("Paramount")
+				));
+
+				// ASSERT
+				assert_equivalent(plural
+					+ make_tuple(actors[0], characters[3], movies[1], productions[1], studios[1])
+					+ make_tuple(actors[1], characters[4], movies[1], productions[1], studios[1])
+					+ make_tuple(actors[2], characters[5], movies[2], productions[2], studios[1])
+					+ make_tuple(actors[3], characters[6], movies[2], productions[2], studios[1]), paramountCast);
+
+				// INIT / ACT
+				auto n = tx->count< tuple<studio, studio, production, production, actor> >();
+
+				// ASSERT
+				assert_equal(2u * 2u * 3u * 3u * 4u, n);
+			}
 		end_test_suite
 	}
 }
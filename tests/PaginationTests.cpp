@@ -0,0 +1,168 @@
+#include <sql2++/database.h>
+
+#include "file_helpers.h"
+#include "helpers.h"
+
+#include <ut/assert.h>
+#include <ut/test.h>
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		namespace
+		{
+			struct post
+			{
+				int id;
+				string author;
+				int rating;
+
+				bool operator ==(const post &rhs) const
+				{	return id == rhs.id && author == rhs.author && rating == rhs.rating;	}
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, post *)
+			{
+				visitor("posts");
+				visitor(identity, &post::id, "id");
+				visitor(&post::author, "author");
+				visitor(&post::rating, "rating");
+
+				visitor << index << &post::rating << &post::id;
+			}
+
+			template <typename T>
+			vector<T> read_reader(reader<T> &&r)
+			{
+				vector<T> result;
+
+				for (T item; r(item); )
+					result.push_back(item);
+				return result;
+			}
+		}
+
+		begin_test_suite( PaginationTests )
+			temporary_directory dir;
+			string path;
+
+			init( CreateSamples )
+			{
+				path = dir.track_file("sample-db.db");
+
+				transaction t(create_connection(path.c_str()));
+				auto posts = plural
+					+ initialize<post>(0, "bob", 5)
+					+ initialize<post>(0, "alice", 3)
+					+ initialize<post>(0, "bob", 3)
+					+ initialize<post>(0, "carol", 7)
+					+ initialize<post>(0, "alice", 5)
+					+ initialize<post>(0, "bob", 1)
+					+ initialize<post>(0, "carol", 3);
+
+				t.create_table<post>();
+				write_all(t, posts);
+				t.commit();
+			}
+
+
+			test( NumberOfRecordsReadIsLimited )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				string author = "bob";
+
+				// ACT / ASSERT
+				assert_equal(plural
+					+ initialize<post>(1, "bob", 5)
+					+ initialize<post>(2, "alice", 3),
+					read_reader(t.select<post>(lit(true), c(&post::id), true, limit(2))));
+				assert_equal(plural
+					+ initialize<post>(3, "bob", 3)
+					+ initialize<post>(1, "bob", 5),
+					read_reader(t.select<post>(c(&post::author) == p(author), c(&post::rating), true, c(&post::id), true,
+						limit(3), offset(1))));
+				assert_equal(plural
+					+ initialize<post>(6, "bob", 1),
+					read_reader(t.select<post>(c(&post::author) == p(author), c(&post::id), false, limit(1))));
+			}
+
+
+			test( OffsetCanBeSpecifiedWithoutLimit )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+
+				// ACT / ASSERT
+				assert_equal(plural
+					+ initialize<post>(6, "bob", 1)
+					+ initialize<post>(7, "carol", 3),
+					read_reader(t.select<post>(lit(true), c(&post::id), true, offset(5))));
+			}
+
+
+			test( PagesAreReadWithASeekPredicate )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				vector<post> all, page;
+
+				// ACT
+				page = read_reader(t.select<post>(lit(true), c(&post::rating), true, c(&post::id), true, limit(3)));
+				while (!page.empty())
+				{
+					all.insert(all.end(), page.begin(), page.end());
+					page = read_reader(t.select<post>(seek_after(all.back(), &post::rating, &post::id),
+						c(&post::rating), true, c(&post::id), true, limit(3)));
+				}
+
+				// ASSERT
+				assert_equal(plural
+					+ initialize<post>(6, "bob", 1)
+					+ initialize<post>(2, "alice", 3)
+					+ initialize<post>(3, "bob", 3)
+					+ initialize<post>(7, "carol", 3)
+					+ initialize<post>(1, "bob", 5)
+					+ initialize<post>(5, "alice", 5)
+					+ initialize<post>(4, "carol", 7), all);
+			}
+
+
+			test( DescendingPagesAreReadWithASeekPredicate )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				post last = {	5, "alice", 5	};
+
+				// ACT
+				auto page = read_reader(t.select<post>(seek_before(last, &post::rating, &post::id),
+					c(&post::rating), false, c(&post::id), false, limit(2)));
+
+				// ASSERT
+				assert_equal(plural
+					+ initialize<post>(1, "bob", 5)
+					+ initialize<post>(7, "carol", 3), page);
+			}
+
+
+			test( SeekingUsesAnIndexAndDoesNotSort )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				post last = {	3, "bob", 3	};
+
+				// ACT
+				auto plan = t.explain_select<post>(seek_after(last, &post::rating, &post::id),
+					c(&post::rating), true, c(&post::id), true, limit(3));
+
+				// ASSERT
+				assert_equal(1u, plan.size());
+				assert_equal(0u, plan[0].detail.find("SEARCH posts USING INDEX posts_rating_id_idx ("));
+			}
+		end_test_suite
+	}
+}
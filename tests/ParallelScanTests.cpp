@@ -0,0 +1,207 @@
+#include <sql2++/scan.h>
+
+#include "file_helpers.h"
+#include "helpers.h"
+
+#include <algorithm>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <ut/assert.h>
+#include <ut/test.h>
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		namespace
+		{
+			struct measurement
+			{
+				int id;
+				int sensor;
+				double value;
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, measurement *)
+			{
+				visitor("measurements");
+				visitor(identity, &measurement::id, "id");
+				visitor(&measurement::sensor, "sensor");
+				visitor(&measurement::value, "value");
+			}
+		}
+
+		begin_test_suite( ParallelScanTests )
+			temporary_directory dir;
+			string path;
+
+			init( CreateSamples )
+			{
+				path = dir.track_file("sample-db.db");
+
+				transaction t(create_connection(path.c_str()));
+
+				t.create_table<measurement>();
+
+				auto ins = t.insert<measurement>();
+
+				for (auto n = 0; n != 10000; ++n)
+				{
+					measurement m = {	0, n % 10, 0.5 * n	};
+
+					ins(m);
+				}
+				t.commit();
+			}
+
+
+			test( RowidRangesArePartitionedEvenly )
+			{
+				// ACT
+				auto p1 = partition_rowids(1, 10, 3);
+				auto p2 = partition_rowids(5, 6, 4);
+				auto p3 = partition_rowids(-3, 3, 1);
+
+				// ASSERT
+				assert_equal(3u, p1.size());
+				assert_equal(1, p1[0].first);
+				assert_equal(4, p1[0].last);
+				assert_equal(5, p1[1].first);
+				assert_equal(7, p1[1].last);
+				assert_equal(8, p1[2].first);
+				assert_equal(10, p1[2].last);
+				assert_equal(2u, p2.size());
+				assert_equal(5, p2[0].first);
+				assert_equal(5, p2[0].last);
+				assert_equal(6, p2[1].first);
+				assert_equal(6, p2[1].last);
+				assert_equal(1u, p3.size());
+				assert_equal(-3, p3[0].first);
+				assert_equal(3, p3[0].last);
+				assert_is_empty(partition_rowids(1, 0, 4));
+				assert_is_empty(partition_rowids(1, 10, 0));
+			}
+
+
+			test( MatchingRecordsAreDeliveredOnceFromEachPartitionThread )
+			{
+				// INIT
+				connection_pool pool(path.c_str(), 4);
+				vector< vector<int> > ids(4);
+				set<thread::id> threads;
+				mutex mtx;
+				const auto sensor = 3;
+
+				// ACT
+				parallel_scan<measurement>(pool, 4, c(&measurement::sensor) == p(sensor),
+					[&] (size_t partition, const measurement &m) {
+
+					ids[partition].push_back(m.id);
+
+					lock_guard<mutex> l(mtx);
+
+					threads.insert(this_thread::get_id());
+				});
+
+				// ASSERT
+				vector<int> all, reference;
+
+				for (auto id = 4; id <= 10000; id += 10)
+					reference.push_back(id);
+				for (auto i = 0u; i != ids.size(); ++i)
+				{
+					assert_equal(250u, ids[i].size());
+					assert_is_true(ids[i].front() > static_cast<int>(i) * 2500);
+					assert_is_true(ids[i].back() <= static_cast<int>(i + 1) * 2500);
+					all.insert(all.end(), ids[i].begin(), ids[i].end());
+				}
+				sort(all.begin(), all.end());
+				assert_equal(reference, all);
+				assert_equal(4u, threads.size());
+			}
+
+
+			test( PartitionsAreReadByRowidRange )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				const auto sensor = 3;
+				const int64_t first = 100, last = 200;
+
+				// ACT
+				auto plan = t.explain_select<measurement>(c(&measurement::sensor) == p(sensor) && rowid() >= p(first)
+					&& rowid() <= p(last));
+
+				// ASSERT
+				assert_equal(1u, plan.size());
+				assert_equal("SEARCH measurements USING INTEGER PRIMARY KEY (rowid>? AND rowid<?)", plan[0].detail);
+			}
+
+
+			test( AllRecordsAreScannedWhenThereAreMorePartitionsThanRecords )
+			{
+				// INIT
+				{
+					transaction t(create_connection(path.c_str()));
+					auto threshold = 2;
+
+					t.remove<measurement>(c(&measurement::id) > p(threshold)).execute();
+					t.commit();
+				}
+
+				connection_pool pool(path.c_str(), 2);
+				vector<size_t> partitions;
+				mutex mtx;
+
+				// ACT
+				parallel_scan<measurement>(pool, 8, [&] (size_t partition, const measurement &) {
+					lock_guard<mutex> l(mtx);
+
+					partitions.push_back(partition);
+				});
+
+				// ASSERT
+				sort(partitions.begin(), partitions.end());
+				assert_equal(plural + (size_t)0 + (size_t)1, partitions);
+			}
+
+
+			test( EmptyTablesAreScannedWithoutCallbacks )
+			{
+				// INIT
+				{
+					transaction t(create_connection(path.c_str()));
+
+					t.remove<measurement>(lit(true)).execute();
+					t.commit();
+				}
+
+				connection_pool pool(path.c_str(), 2);
+				auto calls = 0;
+
+				// ACT
+				parallel_scan<measurement>(pool, 4, [&] (size_t, const measurement &) {	calls++;	});
+
+				// ASSERT
+				assert_equal(0, calls);
+			}
+
+
+			test( ExceptionsFromWorkersArePropagated )
+			{
+				// INIT
+				connection_pool pool(path.c_str(), 3);
+
+				// ACT / ASSERT
+				assert_throws(parallel_scan<measurement>(pool, 3, [] (size_t partition, const measurement &) {
+					if (partition == 1)
+						throw runtime_error("failed");
+				}), runtime_error);
+			}
+		end_test_suite
+	}
+}
@@ -1,5 +1,6 @@
 #include <sql2++/database.h>
 
+#include "allocation_helpers.h"
 #include "file_helpers.h"
 #include "helpers.h"
 
@@ -165,6 +166,42 @@ namespace sql2xx
 					+ initialize<Seller>("Kat Smilings", "1992-12-07", nullable<string>("Salesforce"), nullable<string>("2020-01-01"), nullable<int>()),
 					read_all<Seller>(t));
 			}
+
+			test( ReexecutingUpdatersAndRemoversDoesNotAllocate )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				int id = 0, missing_id = 100;
+				nullable<int> deals_closed;
+				nullable<string> employer;
+				auto update = t.update<Seller>(c(&Seller::id) == p(id), &Seller::deals_closed, deals_closed,
+					&Seller::employer, employer);
+				auto remove = t.remove<Seller>(c(&Seller::id) == p(missing_id));
+
+				employer = nullable<string>("Some long employer name, that does not fit in a small string buffer");
+
+				// ACT
+				allocation_counter counter;
+
+				for (auto n = 0; n != 100; ++n)
+				{
+					id = n % 3 + 1;
+					deals_closed = n;
+					update.reset();
+					update.execute();
+					missing_id = 100 + n;
+					remove.reset();
+					remove.execute();
+				}
+
+				// ASSERT
+				assert_equal(0u, counter.allocations());
+				assert_equivalent(plural
+					+ initialize<Seller>("John Doe", "1978-09-29", employer, nullable<string>(), nullable<int>(99))
+					+ initialize<Seller>("Helen ?", "1980-01-30", employer, nullable<string>(), nullable<int>(97))
+					+ initialize<Seller>("Kat Smilings", "1992-12-07", employer, nullable<string>("2019-07-19"), nullable<int>(98)),
+					read_all<Seller>(t));
+			}
 		end_test_suite
 	}
 }
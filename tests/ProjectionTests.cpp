@@ -0,0 +1,167 @@
+#include <sql2++/database.h>
+
+#include "file_helpers.h"
+#include "helpers.h"
+
+#include <ut/assert.h>
+#include <ut/test.h>
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		namespace
+		{
+			struct book
+			{
+				int id;
+				string title;
+				int year;
+				nullable<string> subtitle;
+				vector<uint8_t> cover;
+			};
+
+			struct book_card
+			{
+				int id;
+				string title;
+				int year;
+
+				bool operator <(const book_card &rhs) const
+				{	return id < rhs.id;	}
+
+				bool operator ==(const book_card &rhs) const
+				{	return id == rhs.id && title == rhs.title && year == rhs.year;	}
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, book *)
+			{
+				visitor("books");
+				visitor(identity, &book::id, "id");
+				visitor(&book::title, "title");
+				visitor(&book::year, "year");
+				visitor(&book::subtitle, "subtitle");
+				visitor(&book::cover, "cover");
+
+				visitor << index << &book::year << &book::title;
+			}
+
+			// A view over a subset of the 'books' columns.
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, book_card *)
+			{
+				visitor("books");
+				visitor(identity, &book_card::id, "id");
+				visitor(&book_card::title, "title");
+				visitor(&book_card::year, "year");
+			}
+
+			template <typename ReaderT, typename T>
+			vector<T> read_projection(ReaderT &&r, T item)
+			{
+				vector<T> result;
+
+				while (r(item))
+					result.push_back(item);
+				return result;
+			}
+		}
+
+		begin_test_suite( ProjectionTests )
+			temporary_directory dir;
+			string path;
+
+			init( CreateSamples )
+			{
+				path = dir.track_file("sample-db.db");
+
+				transaction t(create_connection(path.c_str()));
+				auto books = plural
+					+ initialize<book>(0, "Dune", 1965, nullable<string>(), vector<uint8_t>(100, 1))
+					+ initialize<book>(0, "Solaris", 1961, nullable<string>("A novel"), vector<uint8_t>(10, 2))
+					+ initialize<book>(0, "Ubik", 1969, nullable<string>(), vector<uint8_t>());
+
+				t.create_table<book>();
+				write_all(t, books);
+				t.commit();
+			}
+
+
+			test( SelectedColumnsAreReadIntoTuples )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+
+				// ACT
+				auto r1 = read_projection(t.select(c(&book::title), c(&book::year)).all(), tuple<string, int>());
+				auto r2 = read_projection(t.select(c(&book::subtitle)).all(), tuple< nullable<string> >());
+
+				// ASSERT
+				assert_equivalent(plural
+					+ make_tuple(string("Dune"), 1965)
+					+ make_tuple(string("Solaris"), 1961)
+					+ make_tuple(string("Ubik"), 1969), r1);
+				assert_equal(3u, r2.size());
+				assert_equal(1, count_if(r2.begin(), r2.end(), [] (const tuple< nullable<string> > &v) {
+					return get<0>(v).has_value() && *get<0>(v) == "A novel";
+				}));
+			}
+
+
+			test( ProjectionIsFilteredOrderedAndLimited )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				int year = 1962;
+
+				// ACT
+				auto r = read_projection(t.select(c(&book::year), c(&book::id))
+					.where(c(&book::year) > p(year), c(&book::year), false, limit(1)), tuple<int, int>());
+
+				// ASSERT
+				assert_equal(plural + make_tuple(1969, 3), r);
+			}
+
+
+			test( ProjectionSelectsOnlyTheColumnsRequested )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				int year = 1962;
+
+				// ACT
+				auto b = t.select(c(&book::title), c(&book::year));
+				auto plan = t.explain((b.expression_text() + " WHERE year>1962").c_str());
+
+				// ASSERT
+				assert_equal("SELECT title,year FROM books", b.expression_text());
+				assert_equal(1u, plan.size());
+				assert_equal("SEARCH books USING COVERING INDEX books_year_title_idx (year>?)", plan[0].detail);
+				assert_equal(2, (int)read_projection(t.select(c(&book::title), c(&book::year))
+					.where(c(&book::year) > p(year)), tuple<string, int>()).size());
+			}
+
+
+			test( ViewStructuresReadASubsetOfColumns )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				int year = 1962;
+
+				// ACT
+				auto cards = read_projection(t.select<book_card>(), book_card());
+				auto plan = t.explain_select<book_card>(c(&book_card::year) < p(year));
+
+				// ASSERT
+				assert_equivalent(plural
+					+ initialize<book_card>(1, "Dune", 1965)
+					+ initialize<book_card>(2, "Solaris", 1961)
+					+ initialize<book_card>(3, "Ubik", 1969), cards);
+				assert_equal("SEARCH books USING COVERING INDEX books_year_title_idx (year<?)", plan[0].detail);
+			}
+		end_test_suite
+	}
+}
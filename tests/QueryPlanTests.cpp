@@ -0,0 +1,248 @@
+#include <sql2++/database.h>
+
+#include "file_helpers.h"
+#include "helpers.h"
+
+#include <ut/assert.h>
+#include <ut/test.h>
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		namespace
+		{
+			struct book
+			{
+				int id;
+				string title;
+				int year;
+				int author_id;
+			};
+
+			struct author
+			{
+				int id;
+				string name;
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, book *)
+			{
+				visitor("books");
+				visitor(identity, &book::id, "id");
+				visitor(&book::title, "title");
+				visitor(&book::year, "year");
+				visitor(&book::author_id, "author_id");
+			}
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, author *)
+			{
+				visitor("authors");
+				visitor(identity, &author::id, "id");
+				visitor(&author::name, "name");
+			}
+
+			struct review
+			{
+				int id;
+				int book_id;
+				int rating;
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, review *)
+			{
+				visitor("reviews");
+				visitor(identity, &review::id, "id");
+				visitor(&review::book_id, "book_id");
+				visitor(&review::rating, "rating");
+
+				visitor << index << &review::book_id << desc(&review::rating);
+			}
+
+			struct scan_report
+			{
+				string expression_text, table;
+				size_t rows;
+			};
+		}
+
+		begin_test_suite( QueryPlanTests )
+			temporary_directory dir;
+			string path;
+
+			init( CreateSamples )
+			{
+				path = dir.track_file("sample-db.db");
+
+				transaction t(create_connection(path.c_str()));
+				auto authors = plural
+					+ initialize<author>(0, "Herbert")
+					+ initialize<author>(0, "Lem");
+				auto books = plural
+					+ initialize<book>(0, "Dune", 1965, 1)
+					+ initialize<book>(0, "Solaris", 1961, 2)
+					+ initialize<book>(0, "Eden", 1959, 2)
+					+ initialize<book>(0, "Ubik", 1969, 1)
+					+ initialize<book>(0, "Hyperion", 1989, 1);
+
+				t.create_table<author>();
+				t.create_table<book>();
+				write_all(t, authors);
+				write_all(t, books);
+				t.commit();
+			}
+
+
+			test( PlansOfUnconditionalAndKeyedSelectionsAreReturned )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				int id = 3;
+
+				// ACT
+				auto p1 = t.explain_select<book>();
+				auto p2 = t.explain_select<book>(c(&book::id) == p(id));
+
+				// ASSERT
+				assert_equal(1u, p1.size());
+				assert_equal("SCAN books", p1[0].detail);
+				assert_is_empty(p1[0].children);
+				assert_equal(1u, p2.size());
+				assert_equal("SEARCH books USING INTEGER PRIMARY KEY (rowid=?)", p2[0].detail);
+			}
+
+
+			test( OrderingIsReflectedInThePlan )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				int year = 1960;
+
+				// ACT
+				auto plan = t.explain_select<book>(c(&book::year) > p(year), c(&book::year), true);
+
+				// ASSERT
+				assert_equal(2u, plan.size());
+				assert_equal("SCAN books", plan[0].detail);
+				assert_equal("USE TEMP B-TREE FOR ORDER BY", plan[1].detail);
+			}
+
+
+			test( ExplainingModificationsDoesNotExecuteThem )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				int year = 1965, new_year = 2000;
+
+				// ACT
+				auto p1 = t.explain_update<book>(c(&book::year) == p(year), &book::year, new_year);
+				auto p2 = t.explain_remove<book>(c(&book::id) == p(year));
+				auto p3 = t.explain_count<book>(c(&book::year) < p(year));
+
+				// ASSERT
+				assert_equal("SCAN books", p1[0].detail);
+				assert_equal("SEARCH books USING INTEGER PRIMARY KEY (rowid=?)", p2[0].detail);
+				assert_equal("SCAN books", p3[0].detail);
+				assert_equal(5u, t.count<book>());
+				assert_equal(1u, t.count<book>(c(&book::year) == p(year)));
+			}
+
+
+			test( DeclaredIndicesAreCreatedAndUsed )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				int book_id = 3;
+
+				// ACT
+				t.create_table<review>();
+				auto plan = t.explain_select<review>(c(&review::book_id) == p(book_id), c(&review::rating), false);
+
+				// ASSERT
+				assert_equal(1u, plan.size());
+				assert_equal("SEARCH reviews USING COVERING INDEX reviews_book_id_rating_desc_idx (book_id=?)", plan[0].detail);
+			}
+
+
+			test( NestedPlanNodesAreBuiltIntoATree )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				string text;
+
+				// ACT
+				auto plan = t.explain("SELECT * FROM books WHERE id IN (SELECT author_id FROM books WHERE year > 1960)");
+
+				// ASSERT
+				assert_equal(2u, plan.size());
+				assert_equal("SEARCH books USING INTEGER PRIMARY KEY (rowid=?)", plan[0].detail);
+				assert_equal("LIST SUBQUERY 1", plan[1].detail);
+				assert_is_false(plan[1].children.empty());
+				assert_equal("SCAN books", plan[1].children[0].detail);
+
+				// ACT
+				format_query_plan(text, plan);
+
+				// ASSERT
+				assert_equal(0u, text.find("SEARCH books USING INTEGER PRIMARY KEY (rowid=?)\nLIST SUBQUERY 1\n  SCAN books\n"));
+			}
+
+
+			test( FullScansOfLargeTablesThrowWhenGuarded )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				int id = 2;
+
+				assert_is_true(guard_full_scans(conn, 4));
+
+				transaction t(conn);
+
+				// ACT / ASSERT
+				assert_throws(t.select<book>(), full_scan_error);
+				assert_throws(t.count<book>(c(&book::year) == p(id)), full_scan_error);
+
+				// ACT / ASSERT (no throw)
+				t.select<book>(c(&book::id) == p(id));
+				t.select<author>();
+			}
+
+
+			test( FullScansAreReportedToAHandlerWithTablesResolved )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				vector<scan_report> reports;
+				int id = 1;
+
+				guard_full_scans(conn, 1, [&reports] (const char *expression_text, const char *table, size_t rows) {
+					scan_report r = {	expression_text, table, rows	};
+					reports.push_back(r);
+				});
+
+				transaction t(conn);
+
+				// ACT
+				auto r = t.select< tuple<book, author> >(c<1>(&author::id) == c<0>(&book::author_id));
+
+				// ASSERT
+				assert_equal(1u, reports.size());
+				assert_equal("books", reports[0].table);
+				assert_equal(2u, reports[0].rows);
+
+				// ACT
+				t.select< tuple<book, author> >(c<1>(&author::id) == c<0>(&book::author_id));
+				t.select<author>(c(&author::id) == p(id));
+
+				// ASSERT
+				assert_equal(2u, reports.size());
+				assert_equal(reports[0].expression_text, reports[1].expression_text);
+			}
+		end_test_suite
+	}
+}
@@ -0,0 +1,140 @@
+#include <sql2++/database.h>
+
+#include "file_helpers.h"
+#include "helpers.h"
+
+#include <ut/assert.h>
+#include <ut/test.h>
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		namespace
+		{
+			struct job
+			{
+				int id;
+				string name;
+				nullable<string> worker;
+				int attempts;
+
+				bool operator <(const job &rhs) const
+				{	return id < rhs.id;	}
+
+				bool operator ==(const job &rhs) const
+				{	return id == rhs.id && name == rhs.name && worker == rhs.worker && attempts == rhs.attempts;	}
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, job *)
+			{
+				visitor("jobs");
+				visitor(identity, &job::id, "id");
+				visitor(&job::name, "name");
+				visitor(&job::worker, "worker");
+				visitor(&job::attempts, "attempts");
+			}
+
+			vector<job> read_jobs(reader<job> &&r)
+			{
+				vector<job> result;
+
+				for (job item; r(item); )
+					result.push_back(item);
+				return result;
+			}
+		}
+
+		begin_test_suite( ReturningTests )
+			temporary_directory dir;
+			string path;
+
+			init( CreateSamples )
+			{
+				path = dir.track_file("sample-db.db");
+
+				transaction t(create_connection(path.c_str()));
+				auto jobs = plural
+					+ initialize<job>(0, "backup", nullable<string>(), 0)
+					+ initialize<job>(0, "reindex", nullable<string>(), 2)
+					+ initialize<job>(0, "vacuum", nullable<string>("w1"), 1)
+					+ initialize<job>(0, "report", nullable<string>(), 0);
+
+				t.create_table<job>();
+				write_all(t, jobs);
+				t.commit();
+			}
+
+
+			test( ExecutingUpdatersAndRemoversReturnsNumberOfRecordsChanged )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				int attempts = 0, missing = 100;
+				string worker = "w2";
+
+				// INIT / ACT
+				auto u = t.update<job>(c(&job::attempts) == p(attempts), &job::worker, worker);
+				auto r = t.remove<job>(c(&job::attempts) == p(missing));
+
+				// ACT / ASSERT
+				assert_equal(2, u.execute());
+				assert_equal(0, r.execute());
+
+				// INIT
+				attempts = 2;
+				missing = 1;
+				u.reset();
+				r.reset();
+
+				// ACT / ASSERT
+				assert_equal(1, u.execute());
+				assert_equal(1, r.execute());
+				assert_equal(3u, t.count<job>());
+			}
+
+
+			test( UpdatedRecordsAreReturned )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				string name = "backup", worker = "w7";
+				const auto attempts = 1;
+
+				// ACT
+				auto claimed = read_jobs(t.update_returning<job>(c(&job::name) == p(name) && is_null(c(&job::worker)),
+					&job::worker, worker, &job::attempts, attempts));
+
+				// ASSERT
+				assert_equal(plural + initialize<job>(1, "backup", nullable<string>("w7"), 1), claimed);
+
+				// ACT
+				claimed = read_jobs(t.update_returning<job>(c(&job::name) == p(name) && is_null(c(&job::worker)),
+					&job::worker, worker, &job::attempts, attempts));
+
+				// ASSERT
+				assert_is_empty(claimed);
+			}
+
+
+			test( RemovedRecordsAreReturned )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				int attempts = 0;
+
+				// ACT
+				auto archived = read_jobs(t.remove_returning<job>(c(&job::attempts) > p(attempts)));
+
+				// ASSERT
+				assert_equivalent(plural
+					+ initialize<job>(2, "reindex", nullable<string>(), 2)
+					+ initialize<job>(3, "vacuum", nullable<string>("w1"), 1), archived);
+				assert_equal(2u, t.count<job>());
+			}
+		end_test_suite
+	}
+}
@@ -0,0 +1,401 @@
+#include <sql2++/database.h>
+
+#include "allocation_helpers.h"
+#include "file_helpers.h"
+#include "helpers.h"
+
+#include <thread>
+#include <ut/assert.h>
+#include <ut/test.h>
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		namespace
+		{
+			struct book
+			{
+				int id;
+				string title;
+				int year;
+
+				bool operator <(const book &rhs) const
+				{	return make_tuple(id, title, year) < make_tuple(rhs.id, rhs.title, rhs.year);	}
+			};
+
+			struct author
+			{
+				int id;
+				string name;
+
+				bool operator <(const author &rhs) const
+				{	return make_tuple(id, name) < make_tuple(rhs.id, rhs.name);	}
+			};
+
+			struct review
+			{
+				int id;
+				int book_id;
+				string text;
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, book *)
+			{
+				visitor("books");
+				visitor(identity, &book::id, "id");
+				visitor(&book::title, "title");
+				visitor(&book::year, "year");
+			}
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, author *)
+			{
+				visitor("authors");
+				visitor(identity, &author::id, "id");
+				visitor(&author::name, "name");
+			}
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, review *)
+			{
+				visitor("reviews");
+				visitor(identity, &review::id, "id");
+				visitor(&review::book_id, "book_id");
+				visitor(&review::text, "text");
+				visitor << index << &review::book_id;
+			}
+		}
+
+		begin_test_suite( StatementCacheTests )
+			temporary_directory dir;
+			string path;
+			vector<book> books;
+
+			init( CreateSamples )
+			{
+				path = dir.track_file("sample-db.db");
+
+				transaction t(create_connection(path.c_str()));
+
+				t.create_table<book>();
+				t.create_table<author>();
+				books = plural
+					+ initialize<book>(0, "Dune", 1965)
+					+ initialize<book>(0, "Solaris", 1961)
+					+ initialize<book>(0, "Hyperion", 1989);
+				write_all(t, books);
+				t.commit();
+			}
+
+
+			test( ConnectionsCreatedHaveACacheOfDefaultCapacity )
+			{
+				// INIT / ACT
+				auto conn = create_connection(path.c_str());
+
+				// ACT
+				auto cache = get_statement_cache(conn);
+
+				// ASSERT
+				assert_not_null(cache);
+				assert_equal(static_cast<size_t>(default_statement_cache_capacity), cache->capacity());
+				assert_equal(0u, cache->size());
+				assert_equal(0u, cache->hits());
+				assert_equal(0u, cache->misses());
+			}
+
+
+			test( NoCacheIsAttachedWhenCapacityIsZeroOrConnectionIsForeign )
+			{
+				// INIT
+				sqlite3 *raw = nullptr;
+
+				sqlite3_open_v2(path.c_str(), &raw, SQLITE_OPEN_READWRITE, nullptr);
+
+				// INIT / ACT
+				auto conn1 = create_connection(path.c_str(), 0);
+				connection_ptr conn2(raw, &sqlite3_close);
+
+				// ACT / ASSERT
+				assert_null(get_statement_cache(conn1));
+				assert_null(get_statement_cache(conn2));
+
+				// ACT / ASSERT (statements are still created)
+				transaction t1(conn1);
+				transaction t2(conn2);
+
+				assert_equivalent(books, read_all<book>(t1));
+				assert_equivalent(books, read_all<book>(t2));
+			}
+
+
+			test( RepeatedStatementsAreServedFromTheCache )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				auto cache = get_statement_cache(conn);
+				transaction t(conn);
+				const auto misses = cache->misses();
+
+				// ACT
+				auto r1 = read_all<book>(t);
+
+				// ASSERT
+				assert_equivalent(books, r1);
+				assert_equal(misses + 1, cache->misses());
+				assert_equal(0u, cache->hits());
+
+				// ACT
+				auto r2 = read_all<book>(t);
+				auto r3 = read_all<book>(t);
+
+				// ASSERT
+				assert_equivalent(books, r2);
+				assert_equivalent(books, r3);
+				assert_equal(misses + 1, cache->misses());
+				assert_equal(2u, cache->hits());
+
+				// ACT
+				t.count<book>();
+				t.count<book>();
+
+				// ASSERT
+				assert_equal(misses + 2, cache->misses());
+				assert_equal(3u, cache->hits());
+			}
+
+
+			test( ParametersAreReboundForCachedStatements )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				transaction t(conn);
+				int year = 1960;
+
+				// ACT / ASSERT
+				assert_equal(3u, t.count<book>(c(&book::year) > p(year)));
+				assert_equal(3u, read_all(t.select<book>(c(&book::year) > p(year))).size());
+
+				// INIT
+				year = 1962;
+
+				// ACT / ASSERT
+				assert_equal(2u, t.count<book>(c(&book::year) > p(year)));
+				assert_equal(2u, read_all(t.select<book>(c(&book::year) > p(year))).size());
+				assert_equal(2u, get_statement_cache(conn)->hits());
+			}
+
+
+			test( SimultaneouslyUsedStatementsWithTheSameTextAreIndependent )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				transaction t(conn);
+				book b1, b2;
+				vector<book> read1, read2;
+
+				// INIT / ACT
+				auto r1 = t.select<book>();
+				auto r2 = t.select<book>();
+
+				// ACT
+				while (r1(b1) && r2(b2))
+					read1.push_back(b1), read2.push_back(b2);
+
+				// ASSERT
+				assert_equivalent(books, read1);
+				assert_equivalent(books, read2);
+			}
+
+
+			test( PartiallyReadStatementIsResetBeforeReuse )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				transaction t(conn);
+				book b;
+
+				// ACT
+				{
+					auto r = t.select<book>();
+
+					r(b);
+				}
+
+				// ACT / ASSERT
+				assert_equivalent(books, read_all<book>(t));
+				assert_equal(1u, get_statement_cache(conn)->hits());
+			}
+
+
+			test( RepeatedSelectionsAndCountsDoNotAllocate )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				transaction t(conn);
+				book b;
+
+				t.select<book>();
+				t.count<book>();
+
+				// ACT
+				allocation_counter counter;
+
+				for (auto n = 1000; n--; )
+				{
+					auto r = t.select<book>();
+
+					r(b);
+					t.count<book>();
+				}
+
+				// ASSERT
+				assert_equal(0u, counter.allocations());
+				assert_equal(2000u, get_statement_cache(conn)->hits());
+			}
+
+
+			test( CacheSizeIsBoundedByCapacity )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str(), 2);
+				auto cache = get_statement_cache(conn);
+				transaction t(conn);
+
+				// ACT
+				t.count<book>();
+				t.count<author>();
+				read_all<book>(t);
+				read_all<author>(t);
+
+				// ASSERT
+				assert_equal(2u, cache->size());
+				assert_equal(0u, cache->hits());
+
+				// ACT
+				read_all<author>(t);
+
+				// ASSERT
+				assert_equal(2u, cache->size());
+				assert_equal(1u, cache->hits());
+
+				// ACT
+				t.count<book>();
+
+				// ASSERT
+				assert_equal(2u, cache->size());
+				assert_equal(1u, cache->hits());
+			}
+
+
+			test( StatementsInUseAreNotEvicted )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str(), 1);
+				transaction t(conn);
+				book b;
+
+				// INIT / ACT
+				auto r = t.select<book>();
+
+				// ACT
+				t.count<author>();
+				t.count<book>();
+
+				// ASSERT
+				assert_is_true(r(b));
+				assert_is_true(r(b));
+				assert_is_true(r(b));
+				assert_is_false(r(b));
+			}
+
+
+			test( CachedStatementsAreUsableAcrossTransactions )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				auto cache = get_statement_cache(conn);
+				auto item = initialize<author>(0, "Stanislaw Lem");
+
+				// ACT
+				{
+					transaction t(conn);
+
+					t.insert<author>()(item);
+					t.commit();
+				}
+				{
+					transaction t(conn);
+
+					item.name = "Frank Herbert";
+					t.insert<author>()(item);
+					t.commit();
+				}
+
+				// ASSERT
+				transaction t(conn);
+
+				assert_equivalent(plural
+					+ initialize<author>(1, "Stanislaw Lem")
+					+ initialize<author>(2, "Frank Herbert"), read_all<author>(t));
+				assert_equal(1u, cache->hits());
+			}
+
+
+			test( TransactionControlAndDefinitionsAreNotCached )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				auto cache = get_statement_cache(conn);
+
+				// ACT
+				{
+					transaction t(conn, transaction::immediate);
+
+					t.create_table<review>();
+					t.commit();
+				}
+				transaction(conn).commit();
+				transaction(conn, transaction::exclusive);
+
+				// ASSERT
+				assert_equal(0u, cache->size());
+				assert_equal(0u, cache->misses());
+			}
+
+
+			test( StatementsAreAcquiredAndReleasedFromManyThreads )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str(), 4);
+				vector<thread> threads;
+				const char *queries[] = {	"SELECT 1", "SELECT 2", "SELECT 3", "SELECT 4", "SELECT 5",	};
+
+				// ACT
+				for (auto n = 0; n != 4; ++n)
+				{
+					threads.push_back(thread([&conn, &queries, n] {
+						for (auto i = 0; i != 2000; ++i)
+						{
+							statement s(create_statement(conn, queries[(n + i) % 5]));
+
+							s.execute();
+						}
+					}));
+				}
+				for (auto i = threads.begin(); i != threads.end(); ++i)
+					i->join();
+
+				// ASSERT
+				const auto cache = get_statement_cache(conn);
+
+				assert_equal(8000u, cache->hits() + cache->misses());
+				assert_is_true(cache->size() <= 4u);
+			}
+		end_test_suite
+	}
+}
@@ -0,0 +1,275 @@
+#include <sql2++/database.h>
+
+#include "file_helpers.h"
+#include "helpers.h"
+
+#include <ut/assert.h>
+#include <ut/test.h>
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		namespace
+		{
+			struct book
+			{
+				int id;
+				string title;
+				int year;
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, book *)
+			{
+				visitor("books");
+				visitor(identity, &book::id, "id");
+				visitor(&book::title, "title");
+				visitor(&book::year, "year");
+			}
+
+			connection_ptr create_collecting_connection(const string &path)
+			{
+				connection_options o;
+
+				o.collect_statistics = true;
+				return create_connection(path.c_str(), o);
+			}
+		}
+
+		begin_test_suite( StatementStatsTests )
+			temporary_directory dir;
+			string path;
+
+			init( CreateSamples )
+			{
+				path = dir.track_file("sample-db.db");
+
+				transaction t(create_connection(path.c_str()));
+				auto books = plural
+					+ initialize<book>(0, "Dune", 1965)
+					+ initialize<book>(0, "Solaris", 1961)
+					+ initialize<book>(0, "Hyperion", 1989)
+					+ initialize<book>(0, "Ubik", 1969);
+
+				t.create_table<book>();
+				write_all(t, books);
+				t.commit();
+			}
+
+
+			test( ReaderStatisticsReflectAFullScan )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				auto r = t.select<book>();
+				book b;
+
+				// ACT
+				while (r(b))
+				{	}
+
+				auto s = r.stats();
+
+				// ASSERT
+				assert_equal(4u, s.rows);
+				assert_equal(0u, s.changes);
+				assert_equal(3u, s.fullscan_steps);
+				assert_equal(1u, s.runs);
+				assert_is_true(s.vm_steps > 0u);
+				assert_equal(0u, s.sorts);
+				assert_equal(0.0, s.execute_seconds);
+			}
+
+
+			test( LookupByIdentityAndSortingAreReflected )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				book b;
+				int id = 2, year = 0;
+				auto r1 = t.select<book>(c(&book::id) == p(id));
+				auto r2 = t.select<book>(c(&book::year) > p(year), c(&book::year), true);
+
+				// ACT
+				while (r1(b))
+				{	}
+				while (r2(b))
+				{	}
+
+				// ASSERT
+				assert_equal(1u, r1.stats().rows);
+				assert_equal(0u, r1.stats().fullscan_steps);
+				assert_equal(4u, r2.stats().rows);
+				assert_equal(1u, r2.stats().sorts);
+			}
+
+
+			test( CountersAreNotCarriedOverForCachedStatements )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				book b;
+
+				{
+					auto r = t.select<book>();
+
+					while (r(b))
+					{	}
+				}
+
+				// ACT
+				auto r = t.select<book>();
+
+				r(b);
+
+				// ASSERT
+				assert_equal(1u, r.stats().rows);
+				assert_equal(0u, r.stats().fullscan_steps);
+				assert_equal(1u, r.stats().runs);
+			}
+
+
+			test( ModificationsAreCountedAsChanges )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				int year = 1965;
+				int new_year = 2000;
+				auto ins = t.insert<book>();
+				auto items = plural + initialize<book>(0, "Lorem", 1) + initialize<book>(0, "Ipsum", 2)
+					+ initialize<book>(0, "Amet", 3);
+
+				// ACT
+				ins(items[0]);
+				ins(items.begin() + 1, items.end());
+				auto u = t.update<book>(c(&book::year) < p(year), &book::year, new_year);
+				u.execute();
+				auto rm = t.remove<book>(c(&book::year) == p(new_year));
+				rm.execute();
+
+				// ASSERT
+				assert_equal(3u, ins.stats().changes);
+				assert_equal(4u, u.stats().changes);
+				assert_equal(0u, u.stats().rows);
+				assert_equal(4u, rm.stats().changes);
+			}
+
+
+			test( ChangesMadeByTriggersAreNotCounted )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				transaction t(conn);
+				int year = 1966;
+				int new_year = 2000;
+
+				statement(create_statement(conn, "CREATE TABLE audit (title TEXT)")).execute();
+				statement(create_statement(conn, "CREATE TRIGGER audit_years AFTER UPDATE OF year ON books BEGIN "
+					"INSERT INTO audit VALUES (old.title); INSERT INTO audit VALUES (new.title); END")).execute();
+
+				auto u = t.update<book>(c(&book::year) < p(year), &book::year, new_year);
+
+				// ACT
+				const auto updated = u.execute();
+
+				// ASSERT
+				assert_equal(2u, updated);
+				assert_equal(2u, u.stats().changes);
+			}
+
+
+			test( StatementsNotModifyingRecordsAreNotCreditedWithChanges )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				transaction t(conn);
+				int year = 2000;
+
+				t.update<book>(c(&book::year) < p(year), &book::year, year).execute();
+
+				statement ddl(create_statement(conn, "CREATE TABLE authors (id INTEGER PRIMARY KEY)"));
+				statement pragma(create_statement(conn, "PRAGMA user_version=7"));
+				statement savepoint(create_statement(conn, "SAVEPOINT sp"));
+				statement release(create_statement(conn, "RELEASE sp"));
+
+				// ACT
+				ddl.execute();
+				pragma.execute();
+				savepoint.execute();
+				release.execute();
+
+				// ASSERT
+				assert_equal(0u, ddl.stats().changes);
+				assert_equal(0u, pragma.stats().changes);
+				assert_equal(0u, savepoint.stats().changes);
+				assert_equal(0u, release.stats().changes);
+			}
+
+
+			test( StatisticsAreAggregatedPerConnectionBySQLText )
+			{
+				// INIT
+				auto conn = create_collecting_connection(path);
+				transaction t(conn);
+				book b;
+				int id = 1;
+
+				// ACT
+				for (auto n = 3; n--; )
+				{
+					auto r = t.select<book>();
+
+					while (r(b))
+					{	}
+				}
+				for (; id <= 4; ++id)
+				{
+					auto r = t.select<book>(c(&book::id) == p(id));
+
+					r(b);
+				}
+				t.count<book>();
+
+				// ASSERT
+				auto registry = get_statement_statistics(conn);
+
+				assert_not_null(registry);
+
+				auto scan = registry->find(static_text< format_select<book> >().c_str());
+
+				assert_not_null(scan);
+				assert_equal(12u, scan->rows);
+				assert_equal(3u, scan->runs);
+				assert_equal(9u, scan->fullscan_steps);
+				assert_is_true(scan->execute_seconds > 0.0);
+
+				auto top = registry->top(2, &statement_stats::rows);
+
+				assert_equal(2u, top.size());
+				assert_equal(static_text< format_select<book> >(), top[0].first);
+				assert_equal(4u, top[1].second.rows);
+				assert_equal(4u, top[1].second.runs);
+
+				string report;
+
+				format_statistics_report(report, registry->top(10));
+
+				assert_is_true(report.find(static_text< format_select<book> >()) != string::npos);
+				assert_is_true(report.find("runs=3 rows=12") != string::npos);
+			}
+
+
+			test( NoRegistryIsAttachedByDefault )
+			{
+				// INIT / ACT
+				auto conn = create_connection(path.c_str());
+
+				// ACT / ASSERT
+				assert_null(get_statement_statistics(conn));
+			}
+		end_test_suite
+	}
+}
@@ -0,0 +1,300 @@
+#include <sql2++/database.h>
+
+#include "allocation_helpers.h"
+#include "file_helpers.h"
+#include "helpers.h"
+
+#include <ut/assert.h>
+#include <ut/test.h>
+
+using namespace std;
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		namespace
+		{
+			const auto c_create_sample =
+				"BEGIN;"
+				"CREATE TABLE 'articles' ('id' INTEGER PRIMARY KEY ASC, 'title' TEXT NOT NULL, 'body' TEXT NOT NULL, 'summary' TEXT);"
+				"INSERT INTO 'articles' ('title', 'body', 'summary') VALUES ('Lorem', 'Lorem ipsum amet dolor', NULL);"
+				"INSERT INTO 'articles' ('title', 'body', 'summary') VALUES ('Ipsum', 'Sic transit gloria mundi', 'Latin');"
+				"INSERT INTO 'articles' ('title', 'body', 'summary') VALUES ('', 'Quod erat demonstrandum', '');"
+				"COMMIT;";
+
+			struct article
+			{
+				int id;
+				text_view title;
+				text_view body;
+				nullable<text_view> summary;
+			};
+
+			struct article_copy
+			{
+				int id;
+				string title;
+				string body;
+				nullable<string> summary;
+
+				bool operator <(const article_copy &rhs) const
+				{	return make_tuple(id, title, body, summary) < make_tuple(rhs.id, rhs.title, rhs.body, rhs.summary);	}
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, article *)
+			{
+				visitor("articles");
+				visitor(identity, &article::id, "id");
+				visitor(&article::title, "title");
+				visitor(&article::body, "body");
+				visitor(&article::summary, "summary");
+			}
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, article_copy *)
+			{
+				visitor("articles");
+				visitor(identity, &article_copy::id, "id");
+				visitor(&article_copy::title, "title");
+				visitor(&article_copy::body, "body");
+				visitor(&article_copy::summary, "summary");
+			}
+
+			struct attachment
+			{
+				int id;
+				vector<uint8_t> payload;
+				nullable< vector<uint8_t> > thumbnail;
+
+				bool operator <(const attachment &rhs) const
+				{	return make_tuple(id, payload, thumbnail) < make_tuple(rhs.id, rhs.payload, rhs.thumbnail);	}
+			};
+
+			struct attachment_ref
+			{
+				int id;
+				blob_view payload;
+				nullable<blob_view> thumbnail;
+			};
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, attachment *)
+			{
+				visitor("attachments");
+				visitor(identity, &attachment::id, "id");
+				visitor(&attachment::payload, "payload");
+				visitor(&attachment::thumbnail, "thumbnail");
+			}
+
+			template <typename VisitorT>
+			void describe(VisitorT &visitor, attachment_ref *)
+			{
+				visitor("attachments");
+				visitor(identity, &attachment_ref::id, "id");
+				visitor(&attachment_ref::payload, "payload");
+				visitor(&attachment_ref::thumbnail, "thumbnail");
+			}
+
+			vector<uint8_t> bytes(const char *text, size_t size)
+			{	return vector<uint8_t>(text, text + size);	}
+
+			article_copy copy(const article &from)
+			{
+				article_copy r = {
+					from.id, from.title.str(), from.body.str(), from.summary.and_then([] (text_view v) {	return v.str();	})
+				};
+
+				return r;
+			}
+		}
+
+		begin_test_suite( ViewTests )
+			temporary_directory dir;
+			string path;
+
+			init( CreateSamples )
+			{
+				path = dir.track_file("sample-db.db");
+				auto conn = create_connection(path.c_str());
+
+				sqlite3_exec(conn.get(), c_create_sample, nullptr, nullptr, nullptr);
+			}
+
+
+			test( TextViewsAreConstructedAndCompared )
+			{
+				// INIT
+				const string s = "Lorem ipsum";
+
+				// INIT / ACT
+				text_view v1, v2("Lorem"), v3("Lorem ipsum", 5), v4(s);
+
+				// ACT / ASSERT
+				assert_is_true(v1.empty());
+				assert_equal(0u, v1.size());
+				assert_equal(5u, v2.size());
+				assert_equal(5u, v3.size());
+				assert_equal(11u, v4.size());
+				assert_equal(s.data(), v4.data());
+				assert_equal("Lorem", v3.str());
+				assert_is_true(v2 == v3);
+				assert_is_false(v2 != v3);
+				assert_is_true(v2 != v4);
+				assert_is_true(v2 < v4);
+				assert_is_false(v4 < v2);
+				assert_is_true(v1 < v2);
+			}
+
+
+			test( ViewColumnsAreDefinedAsText )
+			{
+				// INIT
+				string result;
+
+				// ACT
+				format_create_table<article>(result, "articles2");
+
+				// ASSERT
+				assert_equal("CREATE TABLE articles2 (id INTEGER NOT NULL PRIMARY KEY ASC,title TEXT NOT NULL,body TEXT NOT NULL,"
+					"summary TEXT)", result);
+			}
+
+
+			test( TextColumnsAreReadIntoViews )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				vector<article_copy> read;
+
+				// INIT / ACT
+				auto r = t.select<article>();
+
+				// ACT
+				for (article a; r(a); )
+					read.push_back(copy(a));
+
+				// ASSERT
+				assert_equivalent(plural
+					+ initialize<article_copy>(1, "Lorem", "Lorem ipsum amet dolor", nullable<string>())
+					+ initialize<article_copy>(2, "Ipsum", "Sic transit gloria mundi", nullable<string>("Latin"))
+					+ initialize<article_copy>(3, "", "Quod erat demonstrandum", nullable<string>("")), read);
+			}
+
+
+			test( ViewsAreWrittenAndUsedAsParameters )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				const string title = "Amet";
+				const string body = "Dolor sit amet";
+				article a = {	0, title, text_view(body.c_str(), 5), nullable<text_view>(text_view("Dolor"))	};
+				text_view filter = title;
+
+				// ACT
+				t.insert<article>()(a);
+
+				// ASSERT
+				assert_equal(4, a.id);
+				assert_equivalent(plural
+					+ initialize<article_copy>(4, "Amet", "Dolor", nullable<string>("Dolor")),
+					read_all(t.select<article_copy>(c(&article_copy::title) == p(title))));
+				assert_equal(1u, t.count<article>(c(&article::title) == p(filter)));
+			}
+
+
+			test( ScanningIntoViewsDoesNotAllocate )
+			{
+				// INIT
+				auto conn = create_connection(path.c_str());
+				transaction t(conn);
+				size_t total = 0;
+				article a;
+
+				t.select<article>();
+
+				// ACT
+				allocation_counter counter;
+
+				for (auto n = 100; n--; )
+				{
+					auto r = t.select<article>();
+
+					while (r(a))
+						total += a.body.size() + a.title.size() + (a.summary.has_value() ? (*a.summary).size() : 0);
+				}
+
+				// ASSERT
+				assert_equal(0u, counter.allocations());
+				assert_equal(100u * (22 + 24 + 23 + 5 + 5 + 0 + 5 + 0), total);
+			}
+
+			test( BlobColumnsAreDefinedAsBlob )
+			{
+				// INIT
+				string result1, result2;
+
+				// ACT
+				format_create_table<attachment>(result1, "attachments");
+				format_create_table<attachment_ref>(result2, "attachments");
+
+				// ASSERT
+				assert_equal("CREATE TABLE attachments (id INTEGER NOT NULL PRIMARY KEY ASC,payload BLOB NOT NULL,"
+					"thumbnail BLOB)", result1);
+				assert_equal(result1, result2);
+			}
+
+
+			test( BinaryDataIsWrittenAndReadBack )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				auto items = plural
+					+ initialize<attachment>(0, bytes("\x00\x01\x02\xFF", 4), nullable< vector<uint8_t> >())
+					+ initialize<attachment>(0, vector<uint8_t>(), nullable< vector<uint8_t> >(vector<uint8_t>()))
+					+ initialize<attachment>(0, vector<uint8_t>(100000, 0x7E), nullable< vector<uint8_t> >(bytes("\0\0", 2)));
+
+				t.create_table<attachment>();
+
+				// ACT
+				write_all(t, items);
+
+				// ASSERT
+				assert_equivalent(items, read_all<attachment>(t));
+				assert_equal(1u, t.count<attachment>(is_null(c(&attachment::thumbnail))));
+				assert_equal(1u, t.count<attachment>(c(&attachment::payload) == p<const vector<uint8_t> >(bytes("\x00\x01\x02\xFF", 4))));
+			}
+
+
+			test( BinaryDataIsReadIntoViews )
+			{
+				// INIT
+				transaction t(create_connection(path.c_str()));
+				auto items = plural
+					+ initialize<attachment>(0, bytes("\x00\x01\x02\xFF", 4), nullable< vector<uint8_t> >())
+					+ initialize<attachment>(0, vector<uint8_t>(), nullable< vector<uint8_t> >(bytes("\0\0", 2)));
+				vector<attachment> read;
+
+				t.create_table<attachment>();
+				write_all(t, items);
+
+				// INIT / ACT
+				auto r = t.select<attachment_ref>();
+
+				// ACT
+				for (attachment_ref a = {}; r(a); )
+				{
+					attachment copy = {
+						a.id, a.payload.vector(), a.thumbnail.and_then([] (blob_view v) {	return v.vector();	})
+					};
+
+					read.push_back(copy);
+				}
+
+				// ASSERT
+				assert_equivalent(items, read);
+			}
+		end_test_suite
+	}
+}
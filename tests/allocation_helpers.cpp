@@ -0,0 +1,40 @@
+#include "allocation_helpers.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+	std::atomic<std::uint64_t> g_allocations(0);
+}
+
+void *operator new(std::size_t size)
+{
+	g_allocations++;
+	if (const auto p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{	return ::operator new(size);	}
+
+void operator delete(void *p) throw()
+{	std::free(p);	}
+
+void operator delete[](void *p) throw()
+{	std::free(p);	}
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		allocation_counter::allocation_counter()
+			: _start(g_allocations)
+		{	}
+
+		std::uint64_t allocation_counter::allocations() const
+		{	return g_allocations - _start;	}
+	}
+}
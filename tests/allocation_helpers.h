@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+namespace sql2xx
+{
+	namespace tests
+	{
+		class allocation_counter
+		{
+		public:
+			allocation_counter();
+
+			std::uint64_t allocations() const;
+
+		private:
+			std::uint64_t _start;
+		};
+	}
+}
@@ -48,14 +48,7 @@ namespace sql2xx
 
 		template <typename T>
 		std::vector<T> read_all(reader<T> &&reader)
-		{
-			T item;
-			std::vector<T> result;
-
-			while (reader(item))
-				result.push_back(item);
-			return result;
-		}
+		{	return std::vector<T>(reader.begin(), reader.end());	}
 
 		template <typename T>
 		std::vector<T> read_all(transaction &tx)